@@ -0,0 +1,62 @@
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+// =====================================================
+// FreeRTOS configuration for the RTOS build on the TM4C123GH6PM
+// (portable/CCS/ARM_CM4F). posix/FreeRTOSConfig.h is the Linux one.
+
+#include <stdint.h>
+
+#include "clock.h"
+#include "rtos.h"
+
+#define configUSE_PREEMPTION                    1
+#define configUSE_TIME_SLICING                  0
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION 1
+#define configUSE_IDLE_HOOK                     0
+#define configUSE_TICK_HOOK                     1
+#define configUSE_16_BIT_TICKS                  0
+
+// The clock module keeps SysTick at CLOCK_TICK_HZ whatever the run mode is
+#define configCPU_CLOCK_HZ                      (Clock_GetHz())
+#define configTICK_RATE_HZ                      ((TickType_t)CLOCK_TICK_HZ)
+
+#define configMAX_PRIORITIES                    4
+#define configMINIMAL_STACK_SIZE                ((uint16_t)96)
+#define configMAX_TASK_NAME_LEN                 8
+#define configSUPPORT_DYNAMIC_ALLOCATION        1
+#define configSUPPORT_STATIC_ALLOCATION         0
+#define configTOTAL_HEAP_SIZE                   ((size_t)(6 * 1024))
+
+#define configUSE_MUTEXES                       1
+#define configUSE_RECURSIVE_MUTEXES             1
+#define configUSE_COUNTING_SEMAPHORES           0
+#define configUSE_TIMERS                        0
+#define configUSE_CO_ROUTINES                   0
+#define configQUEUE_REGISTRY_SIZE               0
+
+#define configCHECK_FOR_STACK_OVERFLOW          2
+#define configUSE_MALLOC_FAILED_HOOK            1
+
+// Per task CPU usage (Rtos_Show), counted in core cycles
+#define configGENERATE_RUN_TIME_STATS           1
+#define configUSE_TRACE_FACILITY                1
+#define configRUN_TIME_COUNTER_TYPE             uint64_t
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() Rtos_RunTimeInit()
+#define portGET_RUN_TIME_COUNTER_VALUE()        Rtos_RunTime()
+
+#define INCLUDE_vTaskDelay                      1
+#define INCLUDE_xTaskDelayUntil                 1
+#define INCLUDE_xTaskGetCurrentTaskHandle       1
+#define INCLUDE_xSemaphoreGetMutexHolder        1
+#define INCLUDE_vTaskSuspend                    0
+#define INCLUDE_vTaskDelete                     0
+
+// Cortex-M4 interrupt priorities, 3 bits on the TM4C
+#define configPRIO_BITS                         3
+#define configKERNEL_INTERRUPT_PRIORITY         (7 << (8 - configPRIO_BITS))
+#define configMAX_SYSCALL_INTERRUPT_PRIORITY    (5 << (8 - configPRIO_BITS))
+
+#define configASSERT(x)                         if(!(x)){ taskDISABLE_INTERRUPTS(); while(1){} }
+
+#endif
@@ -1,9 +1,16 @@
 #include "Nokia5110.h"
 #include "Symbols.h"
+#include "ramfunc.h"
+#include "profile.h"
+#include "rtos.h"
 
 uint8_t Screen[SCREENW * SCREENH / 8]; // Buffer stores the next image to be printed on the screen
+static uint8_t Background[SCREENW * SCREENH / 8];   // What ClearBitmap puts back, the baked bitmaps
 const unsigned char Masks[8] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80}; // Utilizado na função Nokia5110_ClrPxl
 
+static uint32_t lcd_sysclk = 80000000;  // System clock the SSI prescaler is computed from
+static bool lcd_ready = false;          // SSI0 is powered and may be reprogrammed
+
 // ================== PRIVATE FUNCTIONS ==================
 // The Data/Command pin must be valid when the eighth bit is
 // sent. The SSI module has hardware input and output FIFOs
@@ -44,7 +51,7 @@ void static lcdwrite(enum typeOfWrite type, uint8_t message)
     }
 }
 
-void static lcddatawrite(uint8_t data)
+RAMFUNC void static lcddatawrite(uint8_t data)
 {
     while((SSI0_SR_R & 0x00000002) == 0){}; // Wait until transmit FIFO not full
 
@@ -52,12 +59,24 @@ void static lcddatawrite(uint8_t data)
     SSI0_DR_R = data;                       // Data out
 }
 
+// Smallest even prescaler that keeps SSIClk at or below the PCD8544 maximum
+// SysClk/(CPSDVSR * (1 + SCR)), with SCR = 0
+uint32_t static lcdprescaler(uint32_t sysclk)
+{
+    uint32_t cpsdvsr = (sysclk + LCD_MAX_BAUD - 1) / LCD_MAX_BAUD;
+
+    cpsdvsr = cpsdvsr + (cpsdvsr & 1);      // Must be even number
+    if(cpsdvsr < 2)   cpsdvsr = 2;
+    if(cpsdvsr > 254) cpsdvsr = 254;
+
+    return cpsdvsr;
+}
+
 // =================== PUBLIC FUNCTIONS ===================
 
-// If the system clock is faster than 50 MHz, the SSI baud clock will be
-// faster than the 4 MHz maximum of the Nokia 5110.
-// Assumes: system clock rate of 50 MHz or less [.h] ???
-// Assumes: system clock rate of 80 MHz         [.c] ???
+// The SSI baud clock is derived from the system clock given to
+// Nokia5110_SetSysClock (80 MHz by default), so it always runs as
+// close as possible to the 4 MHz maximum of the Nokia 5110.
 void Nokia5110_Init(void)
 {
     volatile uint32_t delay;
@@ -82,11 +101,11 @@ void Nokia5110_Init(void)
 
     SSI0_CC_R = (SSI0_CC_R&~SSI_CC_CS_M)+SSI_CC_CS_SYSPLL; // Configure for system clock / PLL baud clock source
 
-    // Clock divider for 3.33 MHz SSIClk (80 MHz PLL / 24)
+    // Clock divider for SSIClk <= 4 MHz
     // SysClk/(CPSDVSR * (1 + SCR))
-    // 80 / (24 * (1 + 0)) = 3.33 MHz (slower than 4 MHz)
-    SSI0_CPSR_R = (SSI0_CPSR_R & ~SSI_CPSR_CPSDVSR_M) + 24; // Must be even number
-    SSI0_CR0_R &= ~(SSI_CR0_SCR_M |       // SCR = 0 (3.33 Mbps data rate)
+    // 80 / (20 * (1 + 0)) = 4 MHz, 12.5 / (4 * (1 + 0)) = 3.125 MHz
+    SSI0_CPSR_R = (SSI0_CPSR_R & ~SSI_CPSR_CPSDVSR_M) + lcdprescaler(lcd_sysclk);
+    SSI0_CR0_R &= ~(SSI_CR0_SCR_M |       // SCR = 0
                     SSI_CR0_SPH |         // SPH = 0
                     SSI_CR0_SPO);         // SPO = 0
 
@@ -107,6 +126,25 @@ void Nokia5110_Init(void)
 
     lcdwrite(COMMAND, 0x20);              // We must send 0x20 before modifying the display control mode
     lcdwrite(COMMAND, 0x0C);              // Set display control to normal mode: 0x0D for inverse
+
+    lcd_ready = true;
+}
+
+
+// Recompute the SSI0 prescaler after a system clock change.
+// May be called before Nokia5110_Init to set the initial clock.
+void Nokia5110_SetSysClock(uint32_t sysclk)
+{
+    lcd_sysclk = sysclk;
+
+    if(!lcd_ready)
+        return;
+
+    while((SSI0_SR_R&SSI_SR_BSY) == SSI_SR_BSY){}; // Let the last byte go out
+
+    SSI0_CR1_R &= ~SSI_CR1_SSE;                    // Disable SSI
+    SSI0_CPSR_R = (SSI0_CPSR_R & ~SSI_CPSR_CPSDVSR_M) + lcdprescaler(lcd_sysclk);
+    SSI0_CR1_R |= SSI_CR1_SSE;                     // Enable SSI
 }
 
 
@@ -205,10 +243,20 @@ void Nokia5110_SetCursor(uint8_t newX, uint8_t newY)
 
 // Clear the LCD by writing zeros to the entire screen and
 // reset the cursor to (0,0) (top left corner of screen).
+// RTOS builds send a blank frame through the render task, unless the
+// caller holds the display link for a text screen.
 void Nokia5110_Clear(void)
 {
     int i;
 
+#ifdef RTOS
+    if(!Rtos_LcdHeld())
+    {
+        Rtos_PostFrame(0);
+        return;
+    }
+#endif
+
     for(i = 0; i < (MAX_X * MAX_Y / 8); i = i + 1)
         lcddatawrite(0x00);
 
@@ -218,7 +266,7 @@ void Nokia5110_Clear(void)
 
 // Fill the whole screen by drawing a 48x84 bitmap image.
 // Inputs: ptr pointer to 504 byte bitmap
-void Nokia5110_DrawFullImage(const uint8_t *ptr)
+RAMFUNC void Nokia5110_DrawFullImage(const uint8_t *ptr)
 {
     int i;
 
@@ -232,12 +280,15 @@ void Nokia5110_DrawFullImage(const uint8_t *ptr)
 // The image will appear on the screen after the next call to Nokia5110_DisplayBuffer();
 // threshold: grayscale colors above this number make corresponding pixel 'on' 0 to 14
 // 0 is fine for ships, explosions, projectiles, and bunkers
-void Nokia5110_PrintBMP(uint8_t xpos, uint8_t ypos, const uint8_t *ptr, uint8_t threshold)
+RAMFUNC void Nokia5110_PrintBMP(uint8_t xpos, uint8_t ypos, const uint8_t *ptr, uint8_t threshold)
 {
     // A formatação do BitMap deve ser tal que:
     // ptr[18] deve conter a largura
     // ptr[22] deve conter a altura
 
+    if(!ptr)                            // Empty sprite slot
+        return;
+
     int32_t width = ptr[18], height = ptr[22], i, j;
     uint16_t screenx, screeny;
     uint8_t mask;
@@ -255,6 +306,8 @@ void Nokia5110_PrintBMP(uint8_t xpos, uint8_t ypos, const uint8_t *ptr, uint8_t
     if(threshold > 14)
         threshold = 14;                 // Only full 'on' turns pixel on
 
+    PROFILE_BEGIN();
+
 
     // Bitmaps are encoded backwards, so start at the bottom left corner of the image
 
@@ -303,6 +356,66 @@ void Nokia5110_PrintBMP(uint8_t xpos, uint8_t ypos, const uint8_t *ptr, uint8_t
             }
         }
     }
+
+    PROFILE_END(PROFILE_PRINTBMP);
+}
+
+
+// Lights the lit pixels of a bitmap in a bank-major buffer, Screen or Background
+// Clipped like Nokia5110_PrintBMP, a bitmap that doesn't fit isn't drawn
+RAMFUNC static void Nokia5110_OrBuffer(uint8_t *buffer, uint8_t xpos, uint8_t ypos, const uint8_t *ptr)
+{
+    if(!ptr)                            // Empty sprite slot
+        return;
+
+    int32_t width = ptr[18], height = ptr[22], i, j;
+    uint16_t screenx, screeny;
+    uint8_t mask;
+
+    // Same clipping as Nokia5110_PrintBMP
+    if((height <= 0) || ((width % 2) != 0) || ((xpos + width) > SCREENW) ||
+       (ypos < (height - 1)) || (ypos > SCREENH))
+    {
+        return;
+    }
+
+    screeny = ypos / 8;
+    screenx = xpos + SCREENW * screeny;
+    mask = 0x01 << (ypos % 8);
+    j = ptr[10];
+
+    for(i = 1; i <= (width * height / 2); i = i + 1)
+    {
+        if((ptr[j] >> 4) & 0xF)     buffer[screenx] |= mask;
+        screenx = screenx + 1;
+        if(ptr[j] & 0xF)            buffer[screenx] |= mask;
+        screenx = screenx + 1;
+        j = j + 1;
+
+        if((i % (width / 2)) == 0)     // At the end of a row
+        {
+            if(mask > 0x01) mask = mask >> 1;
+            else
+            {
+                mask = 0x80;
+                screeny = screeny - 1;
+            }
+
+            screenx = xpos + SCREENW * screeny;
+            j = j + (4 - (width / 2) % 4) % 4;  // Skip the padding to 32 bits
+        }
+    }
+}
+
+
+// Like Nokia5110_PrintBMP, but the dark pixels of the bitmap leave the screen
+// as it was: only the lit ones are drawn (OR raster op), so the bitmap goes
+// over what is under it without a blank box around it
+RAMFUNC void Nokia5110_OrBMP(uint8_t xpos, uint8_t ypos, const uint8_t *ptr)
+{
+    PROFILE_BEGIN();
+    Nokia5110_OrBuffer(Screen, xpos, ypos, ptr);
+    PROFILE_END(PROFILE_PRINTBMP);
 }
 
 
@@ -316,16 +429,23 @@ void Nokia5110_ClearBuffer(void)
 
 
 // Fill the whole screen by drawing a 48x84 screen image.
+// RTOS builds only hand a copy to the render task.
 void Nokia5110_DisplayBuffer(void)
 {
+    PROFILE_BEGIN();
+#ifdef RTOS
+    Rtos_PostFrame(Screen);
+#else
     Nokia5110_DrawFullImage(Screen);
+#endif
+    PROFILE_END(PROFILE_DISPLAYBUFFER);
 }
 
 
 // Clear the Image pixel at (i, j), turning it dark.
 // i the column index (0 to 83 in this case), x-coordinate
 // j the row index (0 to 47 in this case), y-coordinate
-void Nokia5110_ClearPixel(uint32_t i, uint32_t j)
+RAMFUNC void Nokia5110_ClearPixel(uint32_t i, uint32_t j)
 {
     Screen[84 * (j >> 3) + i] &= ~Masks[j & 0x07];
 }
@@ -505,18 +625,171 @@ void Nokia5110_SetPixel(uint8_t newX, uint8_t newY)
 }
 
 
-//
-void Nokia5110_ClearBitmap(uint8_t xpos, uint8_t ypos, const uint8_t *ptr)
+// Clear the pixels under a bitmap, (xpos, ypos) being its bottom left corner
+// like in Nokia5110_PrintBMP. A byte of Screen holds 8 rows of a column, so the
+// rows are cleared 8 at a time with a mask instead of pixel by pixel.
+// Baked bitmaps under it are put back from the background instead of cleared
+RAMFUNC void Nokia5110_ClearBitmap(uint8_t xpos, uint8_t ypos, const uint8_t *ptr)
 {
     if(xpos > 83 || ypos > 47 || !ptr)
         return;
 
-    uint8_t i, j;
-    uint8_t width = ptr[18], height = ptr[22];
+    int16_t top = ypos - ptr[22] + 1;   // First row
+    uint8_t right = xpos + ptr[18];     // Column after the last one
+    uint8_t bank, mask, i;
+    uint8_t *row;
+    const uint8_t *back;
+
+    if(top < 0)         top = 0;        // Top cut off
+    if(right > SCREENW) right = SCREENW;    // Right side cut off
+
+    PROFILE_BEGIN();
+
+    for(bank = top >> 3; bank <= (ypos >> 3); bank++)
+    {
+        mask = 0xFF;
+        if(bank == (top >> 3))  mask &= 0xFF << (top & 7);          // Rows above the bitmap
+        if(bank == (ypos >> 3)) mask &= 0xFF >> (7 - (ypos & 7));   // Rows below the bitmap
+
+        row = &Screen[SCREENW * bank];
+        back = &Background[SCREENW * bank];
+        for(i = xpos; i < right; i++)
+            row[i] = (row[i] & ~mask) | (back[i] & mask);
+    }
 
-    for(i = xpos; i < xpos + width; i++)
-        for(j = ypos; j > ypos - height; j--)
-            Nokia5110_ClearPixel(i, j);
+    PROFILE_END(PROFILE_CLEARBITMAP);
+}
+
+// Fused hit test. Draws like Nokia5110_PrintBMP and counts the lit pixels it
+// draws over pixels already lit in layer (Screen or any other bank-major
+// buffer), so a sprite learns it touched something without a second pass.
+// PrintBMP itself has no test, it costs only the sprites drawn with this one.
+// Returns the lit pixels that were already lit in layer
+uint16_t Nokia5110_PrintBMPHits(uint8_t xpos, uint8_t ypos, const uint8_t *ptr, uint8_t threshold, const uint8_t *layer)
+{
+    uint16_t hits = 0;
+
+    if(!ptr)                            // Empty sprite slot
+        return 0;
+
+    int32_t width = ptr[18], height = ptr[22], i, j;
+    uint16_t screenx, screeny;
+    uint8_t mask;
+
+    // Same clipping as PrintBMP
+    if((height <= 0) || ((width % 2) != 0) || ((xpos + width) > SCREENW) ||
+      (ypos < (height - 1)) || (ypos > SCREENH))
+    {
+        return 0;
+    }
+
+    if(threshold > 14)
+        threshold = 14;
+
+    screeny = ypos / 8;
+    screenx = xpos + SCREENW * screeny;
+    mask = 0x01 << (ypos % 8);
+    j = ptr[10];
+
+    for(i = 1; i <= (width * height / 2); i = i + 1)
+    {
+        // The left pixel is in the upper 4 bits
+        if(((ptr[j] >> 4) & 0xF) > threshold)
+        {
+            if(layer[screenx] & mask) hits++;
+            Screen[screenx] |= mask;
+        }
+        else                                    Screen[screenx] &= ~mask;
+
+        screenx = screenx + 1;
+
+        // The right pixel is in the lower 4 bits
+        if((ptr[j] & 0xF) > threshold)
+        {
+            if(layer[screenx] & mask) hits++;
+            Screen[screenx] |= mask;
+        }
+        else                            Screen[screenx] &= ~mask;
+
+        screenx = screenx + 1;
+        j = j + 1;
+
+        if((i % (width / 2)) == 0)     // At the end of a row
+        {
+            if(mask > 0x01) mask = mask >> 1;
+
+            else
+            {
+                mask = 0x80;
+                screeny = screeny - 1;
+            }
+
+            screenx = xpos + SCREENW * screeny;
+
+            // Bitmaps are 32-bit word aligned
+            switch((width / 2) % 4) // Skip any padding
+            {
+                case 0: j = j + 0; break;
+                case 1: j = j + 3; break;
+                case 2: j = j + 2; break;
+                case 3: j = j + 1; break;
+            }
+        }
+    }
+
+    return hits;
+}
+
+// =====================================================
+// ### BACKGROUND ###
+
+// The background holds what doesn't move, drawn once when a level starts.
+// Nokia5110_ClearBitmap puts it back under what is erased, so nothing moving
+// over it has to draw it again
+
+// Empties the background, Nokia5110_ClearBitmap clears to dark again
+void Nokia5110_ClearBackground(void)
+{
+    int i;
+    for(i = 0; i < SCREENW * SCREENH / 8; i = i + 1)
+        Background[i] = 0;
+}
+
+
+// Draws the lit pixels of a bitmap in the background and on the screen,
+// (xpos, ypos) being its bottom left corner like in Nokia5110_PrintBMP
+void Nokia5110_BakeBMP(uint8_t xpos, uint8_t ypos, const uint8_t *ptr)
+{
+    Nokia5110_OrBuffer(Background, xpos, ypos, ptr);
+    Nokia5110_OrBuffer(Screen, xpos, ypos, ptr);
+}
+
+
+// Takes the rectangle of a bitmap out of the background, the screen is left
+// as it is until Nokia5110_ClearBitmap erases it
+void Nokia5110_UnbakeBitmap(uint8_t xpos, uint8_t ypos, const uint8_t *ptr)
+{
+    if(xpos > 83 || ypos > 47 || !ptr)
+        return;
+
+    int16_t top = ypos - ptr[22] + 1;   // First row
+    uint8_t right = xpos + ptr[18];     // Column after the last one
+    uint8_t bank, mask, i;
+    uint8_t *row;
+
+    if(top < 0)         top = 0;        // Top cut off
+    if(right > SCREENW) right = SCREENW;    // Right side cut off
+
+    for(bank = top >> 3; bank <= (ypos >> 3); bank++)
+    {
+        mask = 0xFF;
+        if(bank == (top >> 3))  mask &= 0xFF << (top & 7);          // Rows above the bitmap
+        if(bank == (ypos >> 3)) mask &= 0xFF >> (7 - (ypos & 7));   // Rows below the bitmap
+
+        row = &Background[SCREENW * bank];
+        for(i = xpos; i < right; i++)
+            row[i] &= ~mask;
+    }
 }
 
 // =====================================================
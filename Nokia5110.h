@@ -59,27 +59,35 @@ enum typeOfWrite
 #define MAX_X                   84
 #define MAX_Y                   48
 #define CONTRAST                0xB7
+#define LCD_MAX_BAUD            4000000     // PCD8544 maximum serial clock
 #define SCREENW     84
 #define SCREENH     48
 
+// Screen buffer, bank-major: byte x + 84 * (y / 8), bit y % 8
+extern uint8_t Screen[SCREENW * SCREENH / 8];
+
 // ======================== DEFINES ========================
-#define DC                      (*((volatile uint32_t *)0x40004100))
+// Registers are reached through LCD_REG, which a port may redirect (see posix/)
+#ifndef LCD_REG
+#define LCD_REG(addr)           (*((volatile uint32_t *)(addr)))
+#endif
+#define DC                      LCD_REG(0x40004100)
 #define DC_COMMAND              0
 #define DC_DATA                 0x40
-#define RESET                   (*((volatile uint32_t *)0x40004200))
+#define RESET                   LCD_REG(0x40004200)
 #define RESET_LOW               0
 #define RESET_HIGH              0x80
-#define GPIO_PORTA_DIR_R        (*((volatile uint32_t *)0x40004400))
-#define GPIO_PORTA_AFSEL_R      (*((volatile uint32_t *)0x40004420))
-#define GPIO_PORTA_DEN_R        (*((volatile uint32_t *)0x4000451C))
-#define GPIO_PORTA_AMSEL_R      (*((volatile uint32_t *)0x40004528))
-#define GPIO_PORTA_PCTL_R       (*((volatile uint32_t *)0x4000452C))
-#define SSI0_CR0_R              (*((volatile uint32_t *)0x40008000))
-#define SSI0_CR1_R              (*((volatile uint32_t *)0x40008004))
-#define SSI0_DR_R               (*((volatile uint32_t *)0x40008008))
-#define SSI0_SR_R               (*((volatile uint32_t *)0x4000800C))
-#define SSI0_CPSR_R             (*((volatile uint32_t *)0x40008010))
-#define SSI0_CC_R               (*((volatile uint32_t *)0x40008FC8))
+#define GPIO_PORTA_DIR_R        LCD_REG(0x40004400)
+#define GPIO_PORTA_AFSEL_R      LCD_REG(0x40004420)
+#define GPIO_PORTA_DEN_R        LCD_REG(0x4000451C)
+#define GPIO_PORTA_AMSEL_R      LCD_REG(0x40004528)
+#define GPIO_PORTA_PCTL_R       LCD_REG(0x4000452C)
+#define SSI0_CR0_R              LCD_REG(0x40008000)
+#define SSI0_CR1_R              LCD_REG(0x40008004)
+#define SSI0_DR_R               LCD_REG(0x40008008)
+#define SSI0_SR_R               LCD_REG(0x4000800C)
+#define SSI0_CPSR_R             LCD_REG(0x40008010)
+#define SSI0_CC_R               LCD_REG(0x40008FC8)
 #define SSI_CR0_SCR_M           0x0000FF00  // SSI Serial Clock Rate
 #define SSI_CR0_SPH             0x00000080  // SSI Serial Clock Phase
 #define SSI_CR0_SPO             0x00000040  // SSI Serial Clock Polarity
@@ -94,20 +102,20 @@ enum typeOfWrite
 #define SSI_CPSR_CPSDVSR_M      0x000000FF  // SSI Clock Prescale Divisor
 #define SSI_CC_CS_M             0x0000000F  // SSI Baud Clock Source
 #define SSI_CC_CS_SYSPLL        0x00000000  // Either the system clock (if the PLL bypass is in effect) or the PLL output (default)
-#define SYSCTL_RCGC1_R          (*((volatile uint32_t *)0x400FE104))
-#define SYSCTL_RCGC2_R          (*((volatile uint32_t *)0x400FE108))
+#define SYSCTL_RCGC1_R          LCD_REG(0x400FE104)
+#define SYSCTL_RCGC2_R          LCD_REG(0x400FE108)
 #define SYSCTL_RCGC1_SSI0       0x00000010  // SSI0 Clock Gating Control
 #define SYSCTL_RCGC2_GPIOA      0x00000001  // Port A Clock Gating Control
 
 // ======================== DEFINES PLL ======================== (Obs.: dif)
-#define SYSCTL_RIS_R            (*((volatile uint32_t *)0x400FE050))
+#define SYSCTL_RIS_R            LCD_REG(0x400FE050)
 #define SYSCTL_RIS_PLLLRIS      0x00000040  // PLL Lock Raw Interrupt Status
-#define SYSCTL_RCC_R            (*((volatile uint32_t *)0x400FE060))
+#define SYSCTL_RCC_R            LCD_REG(0x400FE060)
 #define SYSCTL_RCC_XTAL_M       0x000007C0  // Crystal Value
 #define SYSCTL_RCC_XTAL_6MHZ    0x000002C0  // 6 MHz Crystal
 #define SYSCTL_RCC_XTAL_8MHZ    0x00000380  // 8 MHz Crystal
 #define SYSCTL_RCC_XTAL_16MHZ   0x00000540  // 16 MHz Crystal
-#define SYSCTL_RCC2_R           (*((volatile uint32_t *)0x400FE070))
+#define SYSCTL_RCC2_R           LCD_REG(0x400FE070)
 #define SYSCTL_RCC2_USERCC2     0x80000000  // Use RCC2
 #define SYSCTL_RCC2_DIV400      0x40000000  // Divide PLL as 400 MHz vs. 200 MHz
 #define SYSCTL_RCC2_SYSDIV2_M   0x1F800000  // System Clock Divisor 2
@@ -127,6 +135,7 @@ enum typeOfWrite
 
 // ======================== FUNCTIONS PROTOTYPES ========================
 void Nokia5110_Init             (void);
+void Nokia5110_SetSysClock      (uint32_t sysclk);
 void Nokia5110_OutChar          (char data);
 void Nokia5110_OutString        (char *ptr);
 void Nokia5110_OutUDec          (uint16_t n);
@@ -135,6 +144,7 @@ void Nokia5110_SetCursor        (uint8_t newX, uint8_t newY);
 void Nokia5110_Clear            (void);
 void Nokia5110_DrawFullImage    (const uint8_t *ptr);
 void Nokia5110_PrintBMP         (uint8_t xpos, uint8_t ypos, const uint8_t *ptr, uint8_t threshold);
+void Nokia5110_OrBMP            (uint8_t xpos, uint8_t ypos, const uint8_t *ptr);
 void Nokia5110_ClearBuffer      (void);
 void Nokia5110_DisplayBuffer    (void);
 void Nokia5110_ClearPixel       (uint32_t, uint32_t);
@@ -152,6 +162,10 @@ void Nokia5110_Padding          (void);
 void Nokia5110_DrawVLine(uint8_t, uint8_t, uint8_t);
 void Nokia5110_DrawHLine(uint8_t, uint8_t, uint8_t);
 void Nokia5110_ClearBitmap      (uint8_t, uint8_t, const uint8_t *ptr);
+uint16_t Nokia5110_PrintBMPHits (uint8_t xpos, uint8_t ypos, const uint8_t *ptr, uint8_t threshold, const uint8_t *layer);
+void Nokia5110_ClearBackground  (void);
+void Nokia5110_BakeBMP          (uint8_t xpos, uint8_t ypos, const uint8_t *ptr);
+void Nokia5110_UnbakeBitmap     (uint8_t xpos, uint8_t ypos, const uint8_t *ptr);
 
 // =====================================================
 // ### MAIRON FUNCTIONS ###
@@ -15,7 +15,23 @@
 #include "driverlib/pin_map.h"
 
 #include "actions.h"
+#include "animation.h"
+#include "arena.h"
+#include "behavior.h"
 #include "buttons.h"
+#include "clock.h"
+#include "collision.h"
+#include "effect.h"
+#include "flow.h"
+#include "game.h"
+#include "pool.h"
+#include "ramfunc.h"
+#include "profile.h"
+#include "projectile.h"
+#include "rtos.h"
+#include "spawn.h"
+#include "swarm.h"
+#include "wave.h"
 #include "bitmaps.h"
 #include "Nokia5110.h"
 
@@ -28,25 +44,105 @@ uint8_t global_life = 6;
 // Number of enemies killed in survivor mode
 uint8_t survivor_points = 0;
 
+// Survivor mode wave being played, the next one once it is finished
+static uint16_t survivor_wave = 0;
+
 // High score with number of monsters killed in survivor mode
 uint8_t highscore[3]={0,0,0};
 
 // Indicates Story Mode or Survival Mode
 bool mode = 0;
 
+// The level being played
+static Level_t level;
+
+// Something was drawn in the buffer since the screen was updated (see Level_Present)
+static bool level_dirty;
+
+// Behavior programs of the enemies (behavior.h), the comments are the offsets
+static const uint8_t program_chase[] = {
+    BEHAVIOR_CHASE,                 //  0
+    BEHAVIOR_END,                   //  1
+};
+
+// A circle or a zigzag, half the times each
+static const uint8_t program_cucco[] = {
+    BEHAVIOR_RANDOM, 128, 7,        //  0
+    BEHAVIOR_PATH, PATH_CIRCLE, 32, //  3
+    BEHAVIOR_END,                   //  6
+    BEHAVIOR_PATH, PATH_ZIGZAG, 32, //  7
+    BEHAVIOR_END,                   // 10
+};
+
+// Half a figure eight, a feather and a charge of three. Hurt, it charges,
+// dives and shoots
+static const uint8_t program_grand_cucco[] = {
+    BEHAVIOR_LIFE, 3, 12,           //  0 second phase
+    BEHAVIOR_PATH, PATH_EIGHT, 16,  //  3
+    BEHAVIOR_SHOOT,                 //  6
+    BEHAVIOR_CHASE,                 //  7
+    BEHAVIOR_LOOP, 2, 7,            //  8
+    BEHAVIOR_END,                   // 11
+    BEHAVIOR_CHASE,                 // 12
+    BEHAVIOR_LOOP, 4, 12,           // 13
+    BEHAVIOR_PATH, PATH_DIVE, 32,   // 16
+    BEHAVIOR_SHOOT,                 // 19
+    BEHAVIOR_JUMP, 12,              // 20
+};
+
+// Six steps after Link and a rest. Hurt, it doesn't rest but zigzags now and
+// then, a whole period of the path so it ends where it started
+static const uint8_t program_grand_madcucco[] = {
+    BEHAVIOR_LIFE, 6, 10,           //  0 second phase
+    BEHAVIOR_CHASE,                 //  3
+    BEHAVIOR_LOOP, 5, 3,            //  4
+    BEHAVIOR_WAIT, 3,               //  7
+    BEHAVIOR_END,                   //  9
+    BEHAVIOR_CHASE,                 // 10
+    BEHAVIOR_RANDOM, 64, 16,        // 11
+    BEHAVIOR_JUMP, 10,              // 14
+    BEHAVIOR_PATH, PATH_ZIGZAG, 32, // 16
+    BEHAVIOR_JUMP, 10,              // 19
+};
+
+// Stats of each enemy code, Enemy_New copies them in the new enemy
+// Tune the periods with enemy_updates
+static const Archetype_t enemy_archetype[ENEMY_TYPES] = {
+    //  sprite                  w   h   life damage anger behavior  program                 period speed walk         idle
+    {grass_array,               14, 14, 1,   0,     0,    DUMB,     0,                      0,     0,    CLIP_STILL,  CLIP_STILL},    // GRASS
+    {cucco_array,               16, 16, 3,   1,     1,    ACTIVE,   program_cucco,          3,     2,    CLIP_STROLL, CLIP_IDLE},     // CUCCO
+    {grand_cucco_array,         32, 32, 6,   3,     2,    ACTIVE,   program_grand_cucco,    3,     2,    CLIP_STROLL, CLIP_IDLE},     // GRAND_CUCCO
+    {oldman_array,              16, 16, 9,   4,     0,    FOLLOWER, program_chase,          2,     2,    CLIP_WALK,   CLIP_IDLE},     // OLDMAN
+    {grand_madcucco_array,      32, 32, 12,  5,     0,    FOLLOWER, program_grand_madcucco, 2,     2,    CLIP_WALK,   CLIP_IDLE},     // GRAND_MADCUCCO
+    {madcucco_array,            16, 16, 20,  0,     0,    FOLLOWER, program_chase,          2,     2,    CLIP_WALK,   CLIP_IDLE},     // MADCUCCO
+    {cucco_array,               16, 16, 3,   1,     1,    FOLLOWER, program_chase,          2,     2,    CLIP_WALK,   CLIP_IDLE},     // ANGRY_CUCCO
+};
+
+// Step of each direction [UP, RIGHT, DOWN, LEFT]
+static const int8_t enemy_dx[4] = { 0, 1, 0,-1};
+static const int8_t enemy_dy[4] = {-1, 0, 1, 0};
+
+// Enemy update scheduler (see Enemy_Move)
+static uint16_t enemy_tick;         // level ticks since the level started
+uint32_t enemy_updates[STATUSES];   // moves done for each movement style since reset
+
+// Slots of the level monsters (see Level_New)
+static Pool_t enemy_pool;
+
+// Cucco revenge (see Level_Swarm)
+static uint8_t cucco_anger;         // anger of the cuccos hit in this level
+static uint8_t swarm_peck;          // level ticks until the swarm can peck Link again
+
 // =====================================================
 // ### GAME INTERACTIONS ###
 
 // Set initial game configurations
 void Setup(){
 
-    // Configures the clock to run in 12.5 MHz
-    // A Game Boy game runs in 4 MHz
-    SysCtlClockSet(SYSCTL_SYSDIV_20 | SYSCTL_USE_PLL | SYSCTL_XTAL_16MHZ | SYSCTL_OSC_MAIN);
-
-    // Configures SysTick for random numbers
-    SysTickPeriodSet(1000);
-    SysTickEnable();
+    // Configures the clock to run in 80 MHz with a millisecond timebase
+    // SysTick is also used for random numbers
+    // The display link speed follows the clock
+    Clock_Init(CLOCK_RUN);
 
     // Display setup
     Nokia5110_Init();
@@ -56,8 +152,11 @@ void Setup(){
     // Buttons setup
     ConfigureButtons();
 
-    // Initialize the warmap
-    Level_WarMapStart(warmap);
+    // No collision boxes until a level starts
+    Collision_Clear();
+
+    // Cycle counter for PROFILE builds
+    Profile_Init();
 }
 
 // Get the pressed switch information
@@ -74,557 +173,690 @@ uint8_t GetSwitch(uint8_t sw){
     return BUTTON_NOT_PRESSED;
 }
 
+// Wait until any switch is pressed
+// A switch still held from before must be released first
+// The clock is scaled down meanwhile
+void WaitSwitch(){
+    uint8_t previous = Clock_GetMode();
+    Clock_SetMode(CLOCK_IDLE);
+    while(GetSwitch(GetButton())!=BUTTON_NOT_PRESSED){
+        Clock_DelayMs(BUTTON_SCAN_MS);
+    }
+    while(GetSwitch(GetButton())==BUTTON_NOT_PRESSED){
+        Clock_DelayMs(BUTTON_SCAN_MS);
+    }
+    Clock_SetMode(previous);
+}
+
+// =====================================================
+// ### SCREENS ###
+// Each screen is a game state (see game.c). The update handlers draw one
+// frame and return, and Game_Wait sets the time until the next frame.
+
+// Title screen animation
+static uint8_t title_frame;     // frame counter
+static bool title_leaving;      // a key was pressed, playing the exit animation
+
+// Instruction screen
+static uint8_t instructions_frame;  // frame being shown, 0 to 6
+static bool instructions_shown;     // the first frame was shown
+static uint8_t instructions_next;   // where to go when finished
+
+// Selection menu
+static uint8_t menu_index;      // selected option
+static bool menu_drawn;         // the menu is on the screen
+static bool menu_released;      // the key that opened the menu was released
+
+// Story screen
+static uint8_t story_page;      // story text being shown
+static uint8_t story_phase;     // 0 shows the text, 1 waits a key, 2 plays the animation
+static uint8_t story_frame;     // animation frame counter
+
+// High score screen
+static bool highscore_drawn;    // the scores are on the screen
+
 // Generate the title screen animation
-void TitleScreen(){
-    InstructionScreen();
-    while(1){
-        Nokia5110_Clear();
-        Nokia5110_ClearBuffer();
+void TitleScreen_Enter(uint8_t from){
+    title_frame = 0;
+    title_leaving = 0;
 
-        Nokia5110_PrintBMP(25,5,signature,0);
-        Nokia5110_PrintBMP(10,35,TitleLogo,0);
+    Nokia5110_Clear();
+    Nokia5110_ClearBuffer();
 
-        Nokia5110_DisplayBuffer();
+    Nokia5110_PrintBMP(25,5,signature,0);
+    Nokia5110_PrintBMP(10,35,TitleLogo,0);
 
-        Nokia5110_PrintBMP(64,22,defeated_1,0);
-        Nokia5110_DisplayBuffer();
-        SysCtlDelay(SysCtlClockGet() / 15);
-        Nokia5110_PrintBMP(64,22,defeated_2,0);
-        Nokia5110_DisplayBuffer();
-        SysCtlDelay(SysCtlClockGet() / 15);
-        Nokia5110_PrintBMP(64,22,defeated_3,0);
+    Nokia5110_DisplayBuffer();
+    Game_Wait(0);
+}
+
+uint8_t TitleScreen_Update(){
+    const unsigned char *intro[3] = {defeated_1, defeated_2, defeated_3};
+    const unsigned char *outro[2] = {defeated_3, defeated_2};
+
+    // the cucco appears
+    if(title_frame < 3){
+        Nokia5110_PrintBMP(64,22,intro[title_frame],0);
         Nokia5110_DisplayBuffer();
-        SysCtlDelay(SysCtlClockGet() / 15);
+        title_frame++;
+        return STATE_TITLE;
+    }
 
-        while(GetSwitch(GetButton())==BUTTON_NOT_PRESSED){
-            Nokia5110_PrintBMP(64,22,cucco_left_1,0);
-            Nokia5110_DisplayBuffer();
-            SysCtlDelay(SysCtlClockGet() / 15);
-            if(GetSwitch(GetButton())!=BUTTON_NOT_PRESSED) break;
-            Nokia5110_PrintBMP(64,22,cucco_left_2,0);
+    // the cucco walks until a key is pressed
+    if(!title_leaving){
+        if(GetSwitch(GetButton())==BUTTON_NOT_PRESSED){
+            Nokia5110_PrintBMP(64,22,(title_frame & 1) ? cucco_left_1 : cucco_left_2,0);
             Nokia5110_DisplayBuffer();
-            SysCtlDelay(SysCtlClockGet() / 15);
+            title_frame = (title_frame==3) ? 4 : 3;
+            return STATE_TITLE;
         }
-        Nokia5110_PrintBMP(64,22,defeated_3,0);
-        Nokia5110_DisplayBuffer();
-        SysCtlDelay(SysCtlClockGet() / 15);
-        Nokia5110_PrintBMP(64,22,defeated_2,0);
-        Nokia5110_DisplayBuffer();
-        SysCtlDelay(SysCtlClockGet() / 15);
-        Nokia5110_ClearBitmap(64,22,cucco_left_1);
-        Nokia5110_DisplayBuffer();
-        SysCtlDelay(SysCtlClockGet() / 15);
-
-        Nokia5110_Clear();
-        SysCtlDelay(SysCtlClockGet() / 15);
-        Nokia5110_ClearBuffer();
+        title_leaving = 1;
+        title_frame = 0;
+    }
 
-        SelectionScreen();
+    // the cucco disappears
+    switch(title_frame++){
+        case 0:
+        case 1:
+            Nokia5110_PrintBMP(64,22,outro[title_frame-1],0);
+            Nokia5110_DisplayBuffer();
+            break;
+        case 2:
+            Nokia5110_ClearBitmap(64,22,cucco_left_1);
+            Nokia5110_DisplayBuffer();
+            break;
+        case 3:
+            Nokia5110_Clear();
+            break;
+        default:
+            return STATE_MENU;
     }
+    return STATE_TITLE;
+}
+
+void TitleScreen_Exit(uint8_t to){
+    Nokia5110_ClearBuffer();
 }
 
 // Generate the selection screen
-void SelectionScreen(){
-    uint8_t i=0;
-    Nokia5110_PrintBMP(0,47,menubg,0);
-    Nokia5110_PrintBMP(25,43,menu_options,0);
-    Nokia5110_PrintBMP(20,7,seta,0);
-    Nokia5110_DisplayBuffer();
-    while(GetSwitch(GetButton())!=BUTTON_NOT_PRESSED){}
+void SelectionScreen_Enter(uint8_t from){
+    menu_index = 0;
+    menu_drawn = 0;
+    menu_released = 0;
+
+    // coming back from another screen
+    if(from != STATE_TITLE) Game_Wait(430);
+    else Game_Wait(0);
+}
 
-    while(1){
-        switch(GetSwitch(GetButton())){
-            case DOWN:
-                if(i<4){
-                    Nokia5110_PrintBMP(20,7+9*i,blackseta,0);
-                    i++;
-                    Nokia5110_PrintBMP(20,7+9*i,seta,0);
-                    Nokia5110_DisplayBuffer();
-                    SysCtlDelay(SysCtlClockGet() / 10);
-                }
-                break;
+uint8_t SelectionScreen_Update(){
+    if(!menu_drawn){
+        Nokia5110_PrintBMP(0,47,menubg,0);
+        Nokia5110_PrintBMP(25,43,menu_options,0);
+        Nokia5110_PrintBMP(20,7,seta,0);
+        Nokia5110_DisplayBuffer();
+        menu_drawn = 1;
+    }
 
-            case UP:
-                if(i>0){
-                    Nokia5110_PrintBMP(20,7+9*i,blackseta,0);
-                    i--;
-                    Nokia5110_PrintBMP(20,7+9*i,seta,0);
-                    Nokia5110_DisplayBuffer();
-                    SysCtlDelay(SysCtlClockGet() / 10);
-                }
-                break;
+    // waits for the key that opened the menu to be released
+    if(!menu_released){
+        menu_released = (GetSwitch(GetButton())==BUTTON_NOT_PRESSED);
+        return STATE_MENU;
+    }
 
-            case SWORD:
-                Nokia5110_ClearBuffer();
-                if(i==0) StoryScreen();
-                if(i==1){
-                    NewGame();
-                    SysCtlDelay(SysCtlClockGet()/7);
-                    return;
-                }
-                if(i==2){
-                     SurvivorMode();
-                     SysCtlDelay(SysCtlClockGet()/7);
-                     return;
-                }
-                if(i==3) HighScoreScreen();
-                if(i==4) InstructionScreen();
-                i=0;
-                SysCtlDelay(SysCtlClockGet()/7);
-                Nokia5110_PrintBMP(0,47,menubg,0);
-                Nokia5110_PrintBMP(25,43,menu_options,0);
-                Nokia5110_PrintBMP(20,7,seta,0);
+    switch(GetSwitch(GetButton())){
+        case DOWN:
+            if(menu_index<4){
+                Nokia5110_PrintBMP(20,7+9*menu_index,blackseta,0);
+                menu_index++;
+                Nokia5110_PrintBMP(20,7+9*menu_index,seta,0);
                 Nokia5110_DisplayBuffer();
-                break;
+                Game_Wait(300);
+            }
+            break;
 
-            case PAUSE:
-                return;
-        }
+        case UP:
+            if(menu_index>0){
+                Nokia5110_PrintBMP(20,7+9*menu_index,blackseta,0);
+                menu_index--;
+                Nokia5110_PrintBMP(20,7+9*menu_index,seta,0);
+                Nokia5110_DisplayBuffer();
+                Game_Wait(300);
+            }
+            break;
+
+        case SWORD:
+            Nokia5110_ClearBuffer();
+            switch(menu_index){
+                case 0: return STATE_STORY;
+                case 1: return STATE_CAMPAIGN;
+                case 2: return STATE_SURVIVOR;
+                case 3: return STATE_HIGHSCORE;
+                case 4: return STATE_INSTRUCTIONS;
+            }
+            break;
+
+        case PAUSE:
+            return STATE_TITLE;
     }
+    return STATE_MENU;
+}
+
+void SelectionScreen_Exit(uint8_t to){
 }
 
 // Generate the instruction screen
-void InstructionScreen(){
-    SysCtlDelay(SysCtlClockGet()/5);
-    Nokia5110_PrintBMP(0,47,menubg,0);
-    Nokia5110_PrintBMP(20,6,instructions,0);
-    Nokia5110_PrintBMP(20,27,buttonmtx,0);
-    while(1){
-        Nokia5110_PrintBMP(27,12,button0,0);    // UP
-        Nokia5110_PrintBMP(34,17,button0,0);    // RIGHT
-        Nokia5110_PrintBMP(27,22,button0,0);    // DOWN
-        Nokia5110_PrintBMP(20,17,button0,0);    // LEFT
-        Nokia5110_PrintBMP(41,27,button0,0);    // SWORD
-        Nokia5110_PrintBMP(41,12,button0,0);    // PAUSE
+void InstructionScreen_Enter(uint8_t from){
+    // shown at boot before the title, or from the menu
+    instructions_next = (from==STATE_MENU) ? STATE_MENU : STATE_TITLE;
+    instructions_frame = 0;
+    instructions_shown = 0;
+    Game_Wait(600);
+}
 
-        Nokia5110_PrintBMP(50,43,link_left_2,0);   // LINK
+uint8_t InstructionScreen_Update(){
+    // each frame stays until the next update, then SWORD leaves
+    if(instructions_shown && GetSwitch(GetButton())==SWORD) return instructions_next;
 
-        Nokia5110_DisplayBuffer();
-        SysCtlDelay(SysCtlClockGet()/7);
-
-        if(GetSwitch(GetButton())==SWORD) break;
-        Nokia5110_PrintBMP(28,43,blackseta,0);
-        Nokia5110_PrintBMP(32,43,blackseta,0);
-        Nokia5110_PrintBMP(36,43,blackseta,0);
-        Nokia5110_PrintBMP(40,43,blackseta,0);
-        Nokia5110_PrintBMP(27,12,button1,0);    // UP
-        Nokia5110_PrintBMP(20,43,up,0);
-        Nokia5110_PrintBMP(50,43,link_up_1,0);   // LINK
-        Nokia5110_DisplayBuffer();
-        SysCtlDelay(SysCtlClockGet()/3);
+    switch(instructions_frame){
+        case 0:
+            if(!instructions_shown){
+                Nokia5110_PrintBMP(0,47,menubg,0);
+                Nokia5110_PrintBMP(20,6,instructions,0);
+                Nokia5110_PrintBMP(20,27,buttonmtx,0);
+            }
+            Nokia5110_PrintBMP(27,12,button0,0);    // UP
+            Nokia5110_PrintBMP(34,17,button0,0);    // RIGHT
+            Nokia5110_PrintBMP(27,22,button0,0);    // DOWN
+            Nokia5110_PrintBMP(20,17,button0,0);    // LEFT
+            Nokia5110_PrintBMP(41,27,button0,0);    // SWORD
+            Nokia5110_PrintBMP(41,12,button0,0);    // PAUSE
+
+            Nokia5110_PrintBMP(50,43,link_left_2,0);   // LINK
+            break;
 
-        if(GetSwitch(GetButton())==SWORD) break;
-        Nokia5110_PrintBMP(27,12,button0,0);    // UP
-        Nokia5110_PrintBMP(34,17,button1,0);    // RIGHT
-        Nokia5110_PrintBMP(20,43,right,0);
-        Nokia5110_PrintBMP(50,43,link_right_1,0);   // LINK
-        Nokia5110_DisplayBuffer();
-        SysCtlDelay(SysCtlClockGet()/3);
+        case 1:
+            Nokia5110_PrintBMP(28,43,blackseta,0);
+            Nokia5110_PrintBMP(32,43,blackseta,0);
+            Nokia5110_PrintBMP(36,43,blackseta,0);
+            Nokia5110_PrintBMP(40,43,blackseta,0);
+            Nokia5110_PrintBMP(27,12,button1,0);    // UP
+            Nokia5110_PrintBMP(20,43,up,0);
+            Nokia5110_PrintBMP(50,43,link_up_1,0);   // LINK
+            break;
 
-        if(GetSwitch(GetButton())==SWORD) break;
-        Nokia5110_PrintBMP(34,17,button0,0);    // RIGHT
-        Nokia5110_PrintBMP(27,22,button1,0);    // DOWN
-        Nokia5110_PrintBMP(20,43,down,0);
-        Nokia5110_PrintBMP(50,43,link_down_1,0);   // LINK
-        Nokia5110_DisplayBuffer();
-        SysCtlDelay(SysCtlClockGet()/3);
-
-        if(GetSwitch(GetButton())==SWORD) break;
-        Nokia5110_PrintBMP(36,43,blackseta,0);
-        Nokia5110_PrintBMP(27,22,button0,0);    // DOWN
-        Nokia5110_PrintBMP(20,17,button1,0);    // LEFT
-        Nokia5110_PrintBMP(20,43,left,0);
-        Nokia5110_PrintBMP(50,43,link_left_1,0);   // LINK
-        Nokia5110_DisplayBuffer();
-        SysCtlDelay(SysCtlClockGet()/3);
+        case 2:
+            Nokia5110_PrintBMP(27,12,button0,0);    // UP
+            Nokia5110_PrintBMP(34,17,button1,0);    // RIGHT
+            Nokia5110_PrintBMP(20,43,right,0);
+            Nokia5110_PrintBMP(50,43,link_right_1,0);   // LINK
+            break;
 
-        if(GetSwitch(GetButton())==SWORD) break;
-        Nokia5110_PrintBMP(20,17,button0,0);    // LEFT
-        Nokia5110_PrintBMP(41,27,button1,0);    // SWORD
-        Nokia5110_PrintBMP(20,43,attack,0);
-        Nokia5110_PrintBMP(50,43,link_left_attack,0);   // LINK
-        Nokia5110_DisplayBuffer();
-        SysCtlDelay(SysCtlClockGet()/3);
-
-        if(GetSwitch(GetButton())==SWORD) break;
-        Nokia5110_PrintBMP(40,43,blackseta,0);
-        Nokia5110_PrintBMP(41,27,button0,0);    // SWORD
-        Nokia5110_PrintBMP(41,12,button1,0);    // PAUSE
-        Nokia5110_PrintBMP(20,43,pause,0);
-        Nokia5110_PrintBMP(50,43,link_left_attack,0);   // LINK
-        Nokia5110_DisplayBuffer();
-        SysCtlDelay(SysCtlClockGet()/3);
+        case 3:
+            Nokia5110_PrintBMP(34,17,button0,0);    // RIGHT
+            Nokia5110_PrintBMP(27,22,button1,0);    // DOWN
+            Nokia5110_PrintBMP(20,43,down,0);
+            Nokia5110_PrintBMP(50,43,link_down_1,0);   // LINK
+            break;
 
+        case 4:
+            Nokia5110_PrintBMP(36,43,blackseta,0);
+            Nokia5110_PrintBMP(27,22,button0,0);    // DOWN
+            Nokia5110_PrintBMP(20,17,button1,0);    // LEFT
+            Nokia5110_PrintBMP(20,43,left,0);
+            Nokia5110_PrintBMP(50,43,link_left_1,0);   // LINK
+            break;
+
+        case 5:
+            Nokia5110_PrintBMP(20,17,button0,0);    // LEFT
+            Nokia5110_PrintBMP(41,27,button1,0);    // SWORD
+            Nokia5110_PrintBMP(20,43,attack,0);
+            Nokia5110_PrintBMP(50,43,link_left_attack,0);   // LINK
+            break;
+
+        case 6:
+            Nokia5110_PrintBMP(40,43,blackseta,0);
+            Nokia5110_PrintBMP(41,27,button0,0);    // SWORD
+            Nokia5110_PrintBMP(41,12,button1,0);    // PAUSE
+            Nokia5110_PrintBMP(20,43,pause,0);
+            Nokia5110_PrintBMP(50,43,link_left_attack,0);   // LINK
+            break;
     }
+    Nokia5110_DisplayBuffer();
+
+    // the first frame is shorter
+    if(instructions_frame) Game_Wait(1000);
+
+    instructions_shown = 1;
+    instructions_frame = (instructions_frame+1) % 7;
+
+    return STATE_INSTRUCTIONS;
+}
+
+void InstructionScreen_Exit(uint8_t to){
     Nokia5110_Clear();
     Nokia5110_ClearBuffer();
 }
 
 // Generate the story screen
-void StoryScreen(){
-    uint8_t i=0;    // counter for animation
+void StoryScreen_Enter(uint8_t from){
+    story_page = 0;
+    story_phase = 0;
+    story_frame = 0;
+    Game_Wait(600);
+}
 
-    SysCtlDelay(SysCtlClockGet()/5);
-    Nokia5110_PrintBMP(0,47,menubg,0);
+uint8_t StoryScreen_Update(){
     // Link's friend Malon asks for help when her pet Cucco disappeared.
-    Nokia5110_PrintBMP(18,42,story_1,0);
-    Nokia5110_DisplayBuffer();
-    SysCtlDelay(SysCtlClockGet()/5);
-
-    while(GetSwitch(GetButton())==BUTTON_NOT_PRESSED){}
-    // shows up Malons house background
-    Nokia5110_PrintBMP(0,47,malon_house,0);
-    Nokia5110_DisplayBuffer();
-
-    // shows up Malon asking for help
-    for(i=0;i<16;i++){
-        Nokia5110_PrintBMP(40,30,malon_sprite[i%4],0);
-        Nokia5110_DisplayBuffer();
-        SysCtlDelay(SysCtlClockGet()/15);
-    }
-
-    Nokia5110_PrintBMP(0,47,menubg,0);
     // Being a hero, it's his duty to rescue the bird.
-    Nokia5110_PrintBMP(18,34,story_2,0);
-    Nokia5110_DisplayBuffer();
-    SysCtlDelay(SysCtlClockGet()/5);
-
-    while(GetSwitch(GetButton())==BUTTON_NOT_PRESSED){}
-
-    Nokia5110_PrintBMP(0,47,malon_house,0);
-    Nokia5110_DisplayBuffer();
+    // But... there's more than he thought happening outside their village.
+    const unsigned char *text[3] = {story_1, story_2, story_3};
+    const uint8_t text_y[3] = {42, 34, 42};
+    uint8_t i = story_frame;
+
+    switch(story_phase){
+        case 0:
+            Nokia5110_PrintBMP(0,47,menubg,0);
+            Nokia5110_PrintBMP(18,text_y[story_page],text[story_page],0);
+            Nokia5110_DisplayBuffer();
+            story_phase = 1;
+            Game_Wait(600);
+            break;
 
-    for(i=0;i<16;i++){
-        Nokia5110_PrintBMP(40,30,malon_sprite[i%4],0);
-        Nokia5110_PrintBMP(35,46,link_walk_1[i%4],0);
-        Nokia5110_DisplayBuffer();
-        SysCtlDelay(SysCtlClockGet()/15);
-    }
+        case 1:
+            if(GetSwitch(GetButton())==BUTTON_NOT_PRESSED) break;
 
+            if(story_page < 2){
+                // shows up Malons house background
+                Nokia5110_PrintBMP(0,47,malon_house,0);
+            }else{
+                Nokia5110_Clear();
+                Nokia5110_ClearBuffer();
+            }
+            Nokia5110_DisplayBuffer();
+            story_phase = 2;
+            story_frame = 0;
+            Game_Wait(0);
+            break;
 
-    Nokia5110_PrintBMP(0,47,menubg,0);
-    // But... there's more than he thought happening outside their village.
-    Nokia5110_PrintBMP(18,42,story_3,0);
-    Nokia5110_DisplayBuffer();
-    SysCtlDelay(SysCtlClockGet()/5);
-    while(GetSwitch(GetButton())==BUTTON_NOT_PRESSED){}
+        case 2:
+            switch(story_page){
+                case 0:
+                    // shows up Malon asking for help
+                    Nokia5110_PrintBMP(40,30,malon_sprite[i%4],0);
+                    break;
+                case 1:
+                    Nokia5110_PrintBMP(40,30,malon_sprite[i%4],0);
+                    Nokia5110_PrintBMP(35,46,link_walk_1[i%4],0);
+                    break;
+                case 2:
+                    Nokia5110_PrintBMP(35,26,oldman_array[i%2][DOWN],0);
+                    Nokia5110_PrintBMP(36,42,poison,0);
+                    Nokia5110_PrintBMP(10,20,candle_sprites[i%4],0);
+                    Nokia5110_PrintBMP(60,20,candle_sprites[i%4],0);
+                    break;
+            }
+            Nokia5110_DisplayBuffer();
+            Game_Wait(200);
 
-    // Nokia5110_PrintBMP(0,47,menubg,0);
-    Nokia5110_Clear();
-    Nokia5110_ClearBuffer();
-    Nokia5110_DisplayBuffer();
-    for(i=0;i<16;i++){
-        Nokia5110_PrintBMP(35,26,oldman_array[i%2][DOWN],0);
-        Nokia5110_PrintBMP(36,42,poison,0);
-        Nokia5110_PrintBMP(10,20,candle_sprites[i%4],0);
-        Nokia5110_PrintBMP(60,20,candle_sprites[i%4],0);
-        Nokia5110_DisplayBuffer();
-        SysCtlDelay(SysCtlClockGet()/15);
+            story_frame++;
+            if(story_frame==16){
+                story_page++;
+                story_phase = 0;
+                if(story_page==3) return STATE_MENU;
+            }
+            break;
     }
+    return STATE_STORY;
 }
 
-// Display the top 3 high scores
-void HighScoreScreen(){
-    SysCtlDelay(SysCtlClockGet()/5);
-    Nokia5110_PrintBMP(0,47,menubg,0);
-    Nokia5110_PrintBMP(25,37,highscoremenu,0);
+void StoryScreen_Exit(uint8_t to){
+}
 
+// Display the top 3 high scores
+void HighScoreScreen_Enter(uint8_t from){
+    highscore_drawn = 0;
+    Game_Wait(600);
+}
 
+uint8_t HighScoreScreen_Update(){
     int i,d1,d2;
-    for(i=0;i<3;i++){
-        d2 = highscore[i]%10;
-        d1 = highscore[i]/10;
-        Nokia5110_PrintBMP(36,20+9*i,number[d1],0);
-        Nokia5110_PrintBMP(40,20+9*i,number[d2],0);
-    }
 
+    if(!highscore_drawn){
+        Nokia5110_PrintBMP(0,47,menubg,0);
+        Nokia5110_PrintBMP(25,37,highscoremenu,0);
 
+        for(i=0;i<3;i++){
+            d2 = highscore[i]%10;
+            d1 = highscore[i]/10;
+            Nokia5110_PrintBMP(36,20+9*i,number[d1],0);
+            Nokia5110_PrintBMP(40,20+9*i,number[d2],0);
+        }
 
+        Nokia5110_DisplayBuffer();
+        highscore_drawn = 1;
+        Game_Wait(600);
+        return STATE_HIGHSCORE;
+    }
 
-    Nokia5110_DisplayBuffer();
-    SysCtlDelay(SysCtlClockGet()/5);
+    if(GetSwitch(GetButton())!=BUTTON_NOT_PRESSED) return STATE_MENU;
+    return STATE_HIGHSCORE;
+}
 
-    while(GetSwitch(GetButton())==BUTTON_NOT_PRESSED){}
+void HighScoreScreen_Exit(uint8_t to){
 }
 
-// Start a new game
+// =====================================================
+// ### STORY MODE ###
+
+// Story mode levels, and the cutscenes played between them
+#define LEVELS              9
+#define CUTSCENE_1          0
+#define CUTSCENE_2          1
+#define CUTSCENE_3          2
+#define CUTSCENE_5          3
+#define CUTSCENE_6          4
+
+// Monsters of each story mode level
 //  good positions for enemies
 //  0,16  16,16  32,16  48,16  64,16
 //  LINK  16,31  32,31  48,31  64,31
 //  0,47  16,47  32,47  48,47  64,47
-void NewGame(){
+static const Level_Spawn_t level_1[] = {   // [Grass Cutting]
+    {GRASS,32,15,0}, {GRASS,32,31,0}, {GRASS,32,47,0}, {GRASS,48,31,0},
+};
+static const Level_Spawn_t level_2[] = {   // [Cucco Found]
+    {GRASS,16,47,0}, {GRASS,32,15,0},
+};
+static const Level_Spawn_t level_3[] = {   // [Tripple Trouble]
+    {ANGRY_CUCCO,48,31,0}, {ANGRY_CUCCO,32,16,0}, {CUCCO,64,47,0},
+};
+static const Level_Spawn_t level_4[] = {   // [Quadcoptrouble]
+    {CUCCO,48,16,0}, {ANGRY_CUCCO,32,47,0}, {CUCCO,64,47,0}, {ANGRY_CUCCO,64,31,0},
+};
+static const Level_Spawn_t level_5[] = {   // [Cucco's Five]
+    {CUCCO,16,47,0}, {ANGRY_CUCCO,32,16,0}, {CUCCO,32,47,0}, {CUCCO,64,47,0}, {CUCCO,48,16,0},
+};
+static const Level_Spawn_t level_6[] = {   // [Grand Cucco], born in cutscene 3
+    {ANGRY_CUCCO,32,16,0}, {ANGRY_CUCCO,32,47,0}, {GRAND_CUCCO,48,40,0},
+};
+static const Level_Spawn_t level_7[] = {   // [Old Man]
+    {OLDMAN,48,31,0}, {GRASS,32,15,0}, {GRASS,16,47,0}, {GRASS,64,15,0},
+};
+static const Level_Spawn_t level_8[] = {   // [GrandMad Cucco]
+    {GRAND_MADCUCCO,48,47,0},
+};
+static const Level_Spawn_t level_9[] = {   // [THE END], the mad cucco of cutscene 5 where it was left
+    {MADCUCCO,50,46,0},
+};
+
+// Story mode levels in playing order
+static const Level_Def_t story_level[LEVELS] = {
+    //  spawn    spawns kills cutscene
+    {level_1,    4,     4,    CUTSCENE_1},      // LEVEL 1
+    {level_2,    2,     2,    CUTSCENE_2},      // LEVEL 2
+    {level_3,    3,     3,    CUTSCENE_NONE},   // LEVEL 3
+    {level_4,    4,     4,    CUTSCENE_NONE},   // LEVEL 4
+    {level_5,    5,     5,    CUTSCENE_3},      // LEVEL 5
+    {level_6,    3,     3,    CUTSCENE_NONE},   // LEVEL 6
+    {level_7,    4,     4,    CUTSCENE_NONE},   // LEVEL 7
+    {level_8,    1,     1,    CUTSCENE_5},      // LEVEL 8
+    {level_9,    1,     1,    CUTSCENE_6},      // LEVEL 9
+};
+
+// monsters of the cutscenes
+// taken from the level arena by Level_New
+static Enemies_t *queue;
+
+static uint8_t campaign_level;  // current level, or the one the cutscene follows
+static uint8_t campaign_scene;  // cutscene being played, CUTSCENE_NONE if none
+static uint8_t campaign_frame;  // cutscene frame counter
+
+// Plays one frame of a cutscene
+// returns how long the frame stays on the screen, 0 when the cutscene is over
+uint16_t Cutscene_Play(uint8_t scene, uint8_t frame){
+    uint8_t i;
+
+    switch(scene){
+
+        // ========================================
+        // CUTSCENE 1              [Cucco Run Away]
+        case CUTSCENE_1:
+            if(frame==0){
+                queue = Level_New();
+                Enemy_New(queue,CUCCO,48,31);
+                Animation_Start(&queue->animation[0],CLIP_TROT);
+
+                Nokia5110_PrintBMP(16,47,grass_alive,0);
+                Nokia5110_PrintBMP(32,15,grass_alive,0);
+                Nokia5110_PrintBMP(48,31,cucco_right_1,0);
+                Nokia5110_PrintBMP(1,33,link_right_1,0);
+                Nokia5110_DisplayBuffer();
+                return 150;
+            }
+            if(frame<4){
+                const unsigned char *turn[3] = {cucco_right_2, cucco_left_1, cucco_left_2};
+                Nokia5110_PrintBMP(48,31,turn[frame-1],0);
+                Nokia5110_DisplayBuffer();
+                return 150;
+            }
+            if(queue->x[0]<MAX_X-15){
+                Nokia5110_ClearBitmap(queue->x[0],queue->y[0],Enemy_Sprite(queue,0));
+                Nokia5110_DisplayBuffer();
+                queue->x[0] +=2;
+                Enemy_Pose(queue,0,RIGHT);
+                Nokia5110_PrintBMP(queue->x[0],queue->y[0],Enemy_Sprite(queue,0),0);
+                Nokia5110_DisplayBuffer();
+                Animation_Step(&queue->animation[0]);
+                return 120;
+            }
+            Enemy_Remove(queue,0);
+            return 0;
+
+        // ========================================
+        // CUTSCENE 2                 [The Old Man]
+        case CUTSCENE_2:
+            if(frame==0){
+                Nokia5110_PrintBMP(1,33,link_right_1,0);
+                queue = Level_New();
+                Enemy_New(queue,OLDMAN,64,31);
+                Enemy_New(queue,CUCCO,48,31);
+                Animation_Start(&queue->animation[0],CLIP_TROT);
+                Animation_Start(&queue->animation[1],CLIP_TROT);
+            }
+            if(frame<10){
+                Enemy_Pose(queue,0,LEFT);
+                Enemy_Pose(queue,1,RIGHT);
+
+                Nokia5110_PrintBMP(64,31,Enemy_Sprite(queue,0),0);
+                Nokia5110_PrintBMP(48,31,Enemy_Sprite(queue,1),0);
+                Nokia5110_DisplayBuffer();
+                Animation_Step(&queue->animation[0]);
+                Animation_Step(&queue->animation[1]);
+                return 150;
+            }
+            if(frame<13){
+                const unsigned char *puff[3] = {defeated_3, defeated_2, defeated_1};
+                Nokia5110_PrintBMP(48,31,puff[frame-10],0);
+                Nokia5110_DisplayBuffer();
+                return 300;
+            }
+            if(frame<16){
+                const unsigned char *puff[3] = {defeated_1, defeated_2, defeated_3};
+                Nokia5110_PrintBMP(48,31,puff[frame-13],0);
+                Nokia5110_PrintBMP(32,16,puff[frame-13],0);
+                Nokia5110_PrintBMP(64,47,puff[frame-13],0);
+                Nokia5110_DisplayBuffer();
+                return 300;
+            }
+            if(frame==16){
+                i = queue->animation[1].pose;
+                Nokia5110_PrintBMP(48,31,cucco_array[i][LEFT],0);
+                Nokia5110_PrintBMP(32,16,cucco_array[i][RIGHT],0);
+                Nokia5110_PrintBMP(64,47,cucco_array[i][LEFT],0);
+                Nokia5110_DisplayBuffer();
+                return 300;
+            }
+            if(frame==17){
+                Nokia5110_ClearBitmap(64,31,oldman_array[queue->animation[0].pose][LEFT]);
+                Nokia5110_DisplayBuffer();
+                return 300;
+            }
+            Enemy_Remove(queue,0);
+            Enemy_Remove(queue,1);
+            return 0;
+
+        // ========================================
+        // CUTSCENE 3            [Grand Cucco Born]
+        case CUTSCENE_3:
+            if(frame==0){
+                Nokia5110_PrintBMP(1,33,link_right_1,0);
+                queue = Level_New();
+                Enemy_New(queue,CUCCO,64,16);
+                Animation_Start(&queue->animation[0],CLIP_TROT);
+            }
+            if(frame<10){
+                Animation_Step(&queue->animation[0]);
+                i = queue->animation[0].pose;
+
+                Nokia5110_PrintBMP(64,16,cucco_array[i][LEFT],0);
+                Nokia5110_PrintBMP(32,16,cucco_array[i][LEFT],0);
+                Nokia5110_PrintBMP(32,47,cucco_array[i][LEFT],0);
+                Nokia5110_PrintBMP(48,31,cucco_array[i][LEFT],0);
+                Nokia5110_PrintBMP(64,47,cucco_array[i][LEFT],0);
+                Nokia5110_PrintBMP(16,31,oldman_array[i][RIGHT],0);
+                Nokia5110_DisplayBuffer();
+                return 150;
+            }
+            if(frame<13){
+                const unsigned char *puff[3] = {defeated_3, defeated_2, defeated_1};
+                Nokia5110_PrintBMP(48,31,puff[frame-10],0);
+                Nokia5110_PrintBMP(64,16,puff[frame-10],0);
+                Nokia5110_PrintBMP(64,47,puff[frame-10],0);
+                Nokia5110_DisplayBuffer();
+                return 300;
+            }
+            if(frame==13){
+                Nokia5110_ClearBitmap(48,31,defeated_1);
+                Nokia5110_ClearBitmap(64,16,defeated_1);
+                Nokia5110_ClearBitmap(64,47,defeated_1);
+                Nokia5110_ClearBitmap(16,31,defeated_1);
+                Nokia5110_DisplayBuffer();
+                return 300;
+            }
+            // the grand cucco is born in level 6
+            Nokia5110_PrintBMP(48,40,grand_cucco_array[0][UP],0);
+            Nokia5110_DisplayBuffer();
+            return 0;
+
+        // ========================================
+        // CUTSCENE 5          [Everything is Fine]
+        case CUTSCENE_5:
+            if(frame==0){
+                queue = Level_New();
+                Enemy_New(queue,MADCUCCO,50,46);
+                Animation_Start(&queue->animation[0],CLIP_TROT);
+                Nokia5110_PrintBMP(1,33,link_right_1,0);
+                Nokia5110_ClearBitmap(0,7,lifebar_heart[0]);
+                Nokia5110_ClearBitmap(8,7,lifebar_heart[1]);
+                Nokia5110_ClearBitmap(16,7,lifebar_heart[2]);
+                Nokia5110_DisplayBuffer();
+                return 600;
+            }
+            if(frame<=36){
+                // three dialog lines, 12 frames each
+                const unsigned char *dialog[3] = {thankyoulink, butialready, playwithhim};
+                const uint8_t dialog_y[3] = {14, 40, 46};
+                uint8_t line = (frame-1)/12;
+                i = (frame-1)%12;
+
+                if(i==0){
+                    if(line) Nokia5110_ClearBitmap(16,dialog_y[line-1],dialog[line-1]);
+                    Nokia5110_PrintBMP(16,dialog_y[line],dialog[line],0);
+                }
+                Nokia5110_PrintBMP(60,20,malon_sprite[i%4],0);
+                Nokia5110_PrintBMP(50,46,Enemy_Sprite(queue,0),0);
+                Enemy_Pose(queue,0,i%4);
+                Animation_Step(&queue->animation[0]);
+                Nokia5110_DisplayBuffer();
+                return 300;
+            }
+            Nokia5110_ClearBitmap(60,20,malon_sprite[0]);
+            Nokia5110_ClearBitmap(16,46,playwithhim);
+            Nokia5110_DisplayBuffer();
+            return 0;
+
+        // ========================================
+        // CUTSCENE 6                     [The End]
+        case CUTSCENE_6:
+            if(frame==0){
+                Nokia5110_Clear();
+                Nokia5110_ClearBuffer();
+                return 750;
+            }
+            if(frame==1){
+                Nokia5110_PrintBMP(24,30,thanks,0);
+                Nokia5110_DisplayBuffer();
+                return 20;
+            }
+            // waits for a key
+            if(GetSwitch(GetButton())==BUTTON_NOT_PRESSED) return 20;
+            return 0;
+    }
+    return 0;
+}
+
+// Start a new game
+void NewGame_Enter(uint8_t from){
+    // a level was finished, its cutscene or the next level follows
+    if(from==STATE_LEVEL){
+        campaign_scene = story_level[campaign_level].cutscene;
+        if(campaign_scene==CUTSCENE_NONE) campaign_level++;
+        campaign_frame = 0;
+        Game_Wait(0);
+        return;
+    }
 
     Nokia5110_Clear();
-    SysCtlDelay(SysCtlClockGet()/7);
+    Game_Wait(430);
     mode = 0;
     global_life = 6;
 
-    // number of monsters in each level
-    // must be passed as an argument to Level_New
-    uint8_t n;
-
-    // monster queue
-    Enemy_t queue[6]={0,0,0,0,0,0};
-
-    uint8_t i;  // frame counter for cutscenes
-
-    // ========================================
-    // LEVEL 1                  [Grass Cutting]
-     n = 4;
-     queue[0] = Enemy_New(GRASS,32,15,1,0,DUMB);
-     queue[1] = Enemy_New(GRASS,32,31,1,0,DUMB);
-     queue[2] = Enemy_New(GRASS,32,47,1,0,DUMB);
-     queue[3] = Enemy_New(GRASS,48,31,1,0,DUMB);
-     if(!(Level_New(queue,n))) return;
-
-     // ========================================
-     // CUTSCENE 1              [Cucco Run Away]
-     queue[0] = Enemy_New(CUCCO,48,31,1,3,ACTIVE);
-
-     Nokia5110_PrintBMP(16,47,grass_alive,0);
-     Nokia5110_PrintBMP(32,15,grass_alive,0);
-     Nokia5110_PrintBMP(48,31,cucco_right_1,0);
-     Nokia5110_PrintBMP(1,33,link_right_1,0);
-     Nokia5110_DisplayBuffer();
-     SysCtlDelay(SysCtlClockGet()/20);
-     Nokia5110_PrintBMP(48,31,cucco_right_2,0);
-     Nokia5110_DisplayBuffer();
-     SysCtlDelay(SysCtlClockGet()/20);
-     Nokia5110_PrintBMP(48,31,cucco_left_1,0);
-     Nokia5110_DisplayBuffer();
-     SysCtlDelay(SysCtlClockGet()/20);
-     Nokia5110_PrintBMP(48,31,cucco_left_2,0);
-     Nokia5110_DisplayBuffer();
-     SysCtlDelay(SysCtlClockGet()/20);
-
-     while(queue[0].x<MAX_X-15){
-         Nokia5110_ClearBitmap(queue[0].x,queue[0].y,queue[0].last_sprite);
-         Nokia5110_DisplayBuffer();
-         queue[0].x +=2;
-         queue[0].direction = RIGHT;
-         queue[0].last_sprite = queue[0].sprite[queue[0].step][queue[0].direction];
-         queue[0].step = !queue[0].step;
-         Nokia5110_PrintBMP(queue[0].x,queue[0].y,queue[0].last_sprite,0);
-         Nokia5110_DisplayBuffer();
-         SysCtlDelay(SysCtlClockGet()/25);
-     }
-
-     // ========================================
-     // LEVEL 2                    [Cucco Found]
-     n = 2;
-     queue[0] = Enemy_New(GRASS,16,47,1,0,DUMB);
-     queue[1] = Enemy_New(GRASS,32,15,1,0,DUMB);
-     if(!(Level_New(queue,n))) return;
-
-     // ========================================
-     // CUTSCENE 2                 [The Old Man]
-
-     Nokia5110_PrintBMP(1,33,link_right_1,0);
-     queue[0] = Enemy_New(OLDMAN,64,31,3,1,DUMB);
-     queue[1] = Enemy_New(CUCCO,48,31,3,1,DUMB);
-
-     for(i=0;i<10;i++){
-
-         queue[0].last_sprite = queue[0].sprite[queue[0].step][LEFT];
-         queue[0].step = !queue[0].step;
-         queue[1].last_sprite = queue[1].sprite[queue[1].step][RIGHT];
-         queue[1].step = !queue[1].step;
-
-         Nokia5110_PrintBMP(64,31,queue[0].last_sprite,0);
-         Nokia5110_PrintBMP(48,31,queue[1].last_sprite,0);
-         Nokia5110_DisplayBuffer();
-         SysCtlDelay(SysCtlClockGet()/20);
-     }
-
-     Nokia5110_PrintBMP(48,31,defeated_3,0);
-     Nokia5110_DisplayBuffer();
-     SysCtlDelay(SysCtlClockGet()/10);
-     Nokia5110_PrintBMP(48,31,defeated_2,0);
-     Nokia5110_DisplayBuffer();
-     SysCtlDelay(SysCtlClockGet()/10);
-     Nokia5110_PrintBMP(48,31,defeated_1,0);
-     Nokia5110_DisplayBuffer();
-     SysCtlDelay(SysCtlClockGet()/10);
-
-     Nokia5110_PrintBMP(48,31,defeated_1,0);
-     Nokia5110_PrintBMP(32,16,defeated_1,0);
-     Nokia5110_PrintBMP(64,47,defeated_1,0);
-     Nokia5110_DisplayBuffer();
-     SysCtlDelay(SysCtlClockGet()/10);
-     Nokia5110_PrintBMP(48,31,defeated_2,0);
-     Nokia5110_PrintBMP(32,16,defeated_2,0);
-     Nokia5110_PrintBMP(64,47,defeated_2,0);
-     Nokia5110_DisplayBuffer();
-     SysCtlDelay(SysCtlClockGet()/10);
-     Nokia5110_PrintBMP(48,31,defeated_3,0);
-     Nokia5110_PrintBMP(32,16,defeated_3,0);
-     Nokia5110_PrintBMP(64,47,defeated_3,0);
-     Nokia5110_DisplayBuffer();
-     SysCtlDelay(SysCtlClockGet()/10);
-     Nokia5110_PrintBMP(48,31,queue[1].sprite[queue[1].step][LEFT],0);
-     Nokia5110_PrintBMP(32,16,queue[1].sprite[queue[1].step][RIGHT],0);
-     Nokia5110_PrintBMP(64,47,queue[1].sprite[queue[1].step][LEFT],0);
-     Nokia5110_DisplayBuffer();
-     SysCtlDelay(SysCtlClockGet()/10);
-
-     Nokia5110_ClearBitmap(64,31,queue[0].sprite[queue[0].step][LEFT]);
-     Nokia5110_DisplayBuffer();
-     SysCtlDelay(SysCtlClockGet()/10);
-
-     // ========================================
-     // LEVEL 3                [Tripple Trouble]
-     n = 3;
-     queue[0] = Enemy_New(CUCCO,48,31,3,1,FOLLOWER);
-     queue[1] = Enemy_New(CUCCO,32,16,3,1,FOLLOWER);
-     queue[2] = Enemy_New(CUCCO,64,47,3,1,ACTIVE);
-     if(!(Level_New(queue,n))) return;
-
-     // ========================================
-     // LEVEL 4                 [Quadcoptrouble]
-     n = 4;
-     queue[0] = Enemy_New(CUCCO,48,16,3,1,ACTIVE);
-     queue[1] = Enemy_New(CUCCO,32,47,3,1,FOLLOWER);
-     queue[2] = Enemy_New(CUCCO,64,47,3,1,ACTIVE);
-     queue[3] = Enemy_New(CUCCO,64,31,3,1,FOLLOWER);
-     if(!(Level_New(queue,n))) return;
-
-     // ========================================
-     // LEVEL 5                   [Cucco's Five]
-     n = 5;
-     queue[0] = Enemy_New(CUCCO,16,47,3,1,ACTIVE);
-     queue[1] = Enemy_New(CUCCO,32,16,3,1,FOLLOWER);
-     queue[2] = Enemy_New(CUCCO,32,47,3,1,ACTIVE);
-     queue[3] = Enemy_New(CUCCO,64,47,3,1,ACTIVE);
-     queue[4] = Enemy_New(CUCCO,48,16,3,1,ACTIVE);
-     if(!(Level_New(queue,n))) return;
-
-     // ========================================
-     // CUTSCENE 3            [Grand Cucco Born]
-
-     Nokia5110_PrintBMP(1,33,link_right_1,0);
-     queue[0] = Enemy_New(CUCCO,64,16,3,1,ACTIVE);
-
-     for(i=0;i<10;i++){
-         queue[0].last_sprite = queue[0].sprite[queue[0].step][LEFT];
-         queue[0].step = !queue[0].step;
-
-         Nokia5110_PrintBMP(64,16,cucco_array[queue[0].step][LEFT],0);
-         Nokia5110_PrintBMP(32,16,cucco_array[queue[0].step][LEFT],0);
-         Nokia5110_PrintBMP(32,47,cucco_array[queue[0].step][LEFT],0);
-         Nokia5110_PrintBMP(48,31,cucco_array[queue[0].step][LEFT],0);
-         Nokia5110_PrintBMP(64,47,cucco_array[queue[0].step][LEFT],0);
-         Nokia5110_PrintBMP(16,31,oldman_array[queue[0].step][RIGHT],0);
-         Nokia5110_DisplayBuffer();
-         SysCtlDelay(SysCtlClockGet()/20);
-     }
-
-     Nokia5110_PrintBMP(48,31,defeated_3,0);
-     Nokia5110_PrintBMP(64,16,defeated_3,0);
-     Nokia5110_PrintBMP(64,47,defeated_3,0);
-     Nokia5110_DisplayBuffer();
-     SysCtlDelay(SysCtlClockGet()/10);
-     Nokia5110_PrintBMP(48,31,defeated_2,0);
-     Nokia5110_PrintBMP(64,16,defeated_2,0);
-     Nokia5110_PrintBMP(64,47,defeated_2,0);
-     Nokia5110_DisplayBuffer();
-     SysCtlDelay(SysCtlClockGet()/10);
-     Nokia5110_PrintBMP(48,31,defeated_1,0);
-     Nokia5110_PrintBMP(64,16,defeated_1,0);
-     Nokia5110_PrintBMP(64,47,defeated_1,0);
-     Nokia5110_DisplayBuffer();
-     SysCtlDelay(SysCtlClockGet()/10);
-     Nokia5110_ClearBitmap(48,31,defeated_1);
-     Nokia5110_ClearBitmap(64,16,defeated_1);
-     Nokia5110_ClearBitmap(64,47,defeated_1);
-     Nokia5110_ClearBitmap(16,31,defeated_1);
-     Nokia5110_DisplayBuffer();
-     SysCtlDelay(SysCtlClockGet()/10);
-
-     queue[2] = Enemy_New(GRAND_CUCCO,48,40,3,1,ACTIVE);
-
-     // ========================================
-     // LEVEL 6                    [Grand Cucco]
-     n = 3;
-     queue[0] = Enemy_New(CUCCO,32,16,3,1,FOLLOWER);
-     queue[1] = Enemy_New(CUCCO,32,47,3,1,FOLLOWER);
-     queue[2] = Enemy_New(GRAND_CUCCO,48,40,6,3,ACTIVE);
-     if(!(Level_New(queue,n))) return;
-
-     // ========================================
-     // LEVEL 7                        [Old Man]
-     n = 4;
-     queue[0] = Enemy_New(OLDMAN,48,31,9,4,FOLLOWER);
-     queue[1] = Enemy_New(GRASS,32,15,1,0,DUMB);
-     queue[2] = Enemy_New(GRASS,16,47,1,0,DUMB);
-     queue[3] = Enemy_New(GRASS,64,15,1,0,DUMB);
-     if(!(Level_New(queue,n))) return;
-
-    // ========================================
-    // LEVEL 8                 [GrandMad Cucco]
-    n = 1;
-    queue[0] = Enemy_New(GRAND_MADCUCCO,48,47,12,5,FOLLOWER);
-    if(!(Level_New(queue,n))) return;
-
-    // ========================================
-    // CUTSCENE 5          [Everything is Fine]
-
-    queue[0] = Enemy_New(MADCUCCO,50,46,20,0,FOLLOWER);
-    Nokia5110_PrintBMP(1,33,link_right_1,0);
-    Nokia5110_ClearBitmap(0,7,lifebar_heart[0]);
-    Nokia5110_ClearBitmap(8,7,lifebar_heart[1]);
-    Nokia5110_ClearBitmap(16,7,lifebar_heart[2]);
-    Nokia5110_DisplayBuffer();
-    SysCtlDelay(SysCtlClockGet()/5);
-
-    Nokia5110_PrintBMP(16,14,thankyoulink,0);
-    for(i=0;i<12;i++){
-        Nokia5110_PrintBMP(60,20,malon_sprite[i%4],0);
-        Nokia5110_PrintBMP(50,46,queue[0].last_sprite,0);
-        queue[0].step = !queue[0].step;
-        queue[0].last_sprite = queue[0].sprite[queue[0].step][i%4];
-        Nokia5110_DisplayBuffer();
-        SysCtlDelay(SysCtlClockGet()/10);
-    }
+    // the random walkers get a seed for the game
+    srand(SysTickValueGet());
 
-    Nokia5110_ClearBitmap(16,14,thankyoulink);
-    Nokia5110_PrintBMP(16,40,butialready,0);
-    for(i=0;i<12;i++){
-        Nokia5110_PrintBMP(60,20,malon_sprite[i%4],0);
-        Nokia5110_PrintBMP(50,46,queue[0].last_sprite,0);
-        queue[0].step = !queue[0].step;
-        queue[0].last_sprite = queue[0].sprite[queue[0].step][i%4];
-        Nokia5110_DisplayBuffer();
-        SysCtlDelay(SysCtlClockGet()/10);
-    }
+    campaign_level = 0;
+    campaign_scene = CUTSCENE_NONE;
+    campaign_frame = 0;
+}
 
-    Nokia5110_ClearBitmap(16,40,butialready);
-    Nokia5110_PrintBMP(16,46,playwithhim,0);
-    for(i=0;i<12;i++){
-        Nokia5110_PrintBMP(60,20,malon_sprite[i%4],0);
-        Nokia5110_PrintBMP(50,46,queue[0].last_sprite,0);
-        queue[0].step = !queue[0].step;
-        queue[0].last_sprite = queue[0].sprite[queue[0].step][i%4];
-        Nokia5110_DisplayBuffer();
-        SysCtlDelay(SysCtlClockGet()/10);
+uint8_t NewGame_Update(){
+    uint16_t wait;
+
+    if(campaign_scene!=CUTSCENE_NONE){
+        wait = Cutscene_Play(campaign_scene,campaign_frame++);
+        if(wait){
+            Game_Wait(wait);
+        }else{
+            campaign_scene = CUTSCENE_NONE;
+            campaign_level++;
+            campaign_frame = 0;
+            Game_Wait(0);
+        }
+        return STATE_CAMPAIGN;
     }
-    Nokia5110_ClearBitmap(60,20,malon_sprite[0]);
-    Nokia5110_ClearBitmap(16,46,playwithhim);
-    Nokia5110_DisplayBuffer();
 
-    // ========================================
-    // LEVEL 9                      [THE END]
-    n = 1;
-    if(!(Level_New(queue,n))) return;
-    // ========================================
-    // CUTSCENE 6                     [The End]
-    Nokia5110_Clear();
-    Nokia5110_ClearBuffer();
-    SysCtlDelay(SysCtlClockGet()/4);
-    Nokia5110_PrintBMP(24,30,thanks,0);
-    Nokia5110_DisplayBuffer();
-    while(GetSwitch(GetButton())==BUTTON_NOT_PRESSED){}
+    if(campaign_level>=LEVELS) return STATE_TITLE;
+    Level_Load(&story_level[campaign_level]);
+    return STATE_LEVEL;
+}
+
+void NewGame_Exit(uint8_t to){
 }
 
+// =====================================================
+// ### HUD ###
+
 // Update lifebar heart sprites when Link's life change
 void Lifebar_Update(uint8_t life){
     switch(life){
@@ -668,261 +900,749 @@ void Lifebar_Update(uint8_t life){
     Nokia5110_PrintBMP(0,7,lifebar_heart[0],0);
     Nokia5110_PrintBMP(8,7,lifebar_heart[1],0);
     Nokia5110_PrintBMP(16,7,lifebar_heart[2],0);
-    Nokia5110_DisplayBuffer();
+    level_dirty = 1;
+}
+
+// Put the number of killed enemies on screen
+void DisplayScore(){
+    int d1,d2;
+
+    d2 = survivor_points%10;
+    d1 = survivor_points/10;
+
+    Nokia5110_PrintBMP(73,7,blackseta,0);
+    Nokia5110_PrintBMP(73,5,blackseta,0);
+    Nokia5110_PrintBMP(74,7,number[d1],0);
+    Nokia5110_PrintBMP(78,7,number[d2],0);
+    level_dirty = 1;
 }
 
 // Pauses the game and asks for continue or quit
-bool Pause(){
-    uint8_t i=0;
-    while(GetSwitch(GetButton())==PAUSE){}
+static uint8_t pause_option;    // 0 quits, 1 continues
+static bool pause_released;     // the PAUSE key was released
+
+#ifdef PROFILE
+// Shows the high-water marks of the level arena, in bytes, and of the pools,
+// in slots, to size them
+//  ARNA   nnnnn
+//  ENMY   nnnnn
+//  PROJ   nnnnn
+//  EFCT   nnnnn
+static void Pause_Memory(void){
+    Nokia5110_Clear();
+    Nokia5110_OutString("ARNA ");
+    Nokia5110_OutUDec(Arena_High());
+    Nokia5110_SetCursor(0, 1);
+    Nokia5110_OutString("ENMY ");
+    Nokia5110_OutUDec(enemy_pool.high);
+    Nokia5110_SetCursor(0, 2);
+    Nokia5110_OutString("PROJ ");
+    Nokia5110_OutUDec(Projectile_High());
+    Nokia5110_SetCursor(0, 3);
+    Nokia5110_OutString("EFCT ");
+    Nokia5110_OutUDec(Effect_High());
+}
+#endif
+
+void Pause_Enter(uint8_t from){
+    pause_option = 0;
+    pause_released = 0;
+
+    // PROFILE builds show the measures before the menu
+    // The display link is held so the render task won't draw over them
+    #ifdef PROFILE
+    Rtos_LcdTake();
+    Profile_Show(0);
+    WaitSwitch();
+    Profile_Reset();
+    Pause_Memory();
+    WaitSwitch();
+    Rtos_LcdGive();
+    #endif
+
+    // RTOS builds show the CPU usage of each task
+    #ifdef RTOS
+    Rtos_LcdTake();
+    Rtos_Show();
+    WaitSwitch();
+    Rtos_LcdGive();
+    #endif
+
+    Nokia5110_PrintBMP(34,8,pausemenu,0);
+    Nokia5110_PrintBMP(54,6,invseta,0);
+    Nokia5110_DisplayBuffer();
+}
+
+uint8_t Pause_Update(){
+    if(!pause_released){
+        pause_released = (GetSwitch(GetButton())!=PAUSE);
+        return STATE_PAUSE;
+    }
+
+    switch(GetSwitch(GetButton())){
+        case LEFT:
+            if(pause_option){
+                Nokia5110_ClearBitmap(71,6,invseta);
+                pause_option=!pause_option;
+                Nokia5110_PrintBMP(54,6,invseta,0);
+                Nokia5110_DisplayBuffer();
+                Game_Wait(300);
+            }
+            break;
+
+        case RIGHT:
+            if(!pause_option){
+                Nokia5110_ClearBitmap(54,6,invseta);
+                pause_option=!pause_option;
+                Nokia5110_PrintBMP(71,6,invseta,0);
+                Nokia5110_DisplayBuffer();
+                Game_Wait(300);
+            }
+            break;
+
+        case SWORD:
+            if(!pause_option){
+                level.link.life = 0;
+                return STATE_GAMEOVER;
+            }
+            return STATE_LEVEL;
+    }
+    return STATE_PAUSE;
+}
+
+void Pause_Exit(uint8_t to){
+    Nokia5110_ClearBitmap(34,8,pausemenu);
+    Nokia5110_ClearBitmap(54,6,invseta);
+    Nokia5110_ClearBitmap(71,6,invseta);
+
+    // quitting leaves the level, and its background, behind
+    if(to!=STATE_LEVEL) Nokia5110_ClearBackground();
+}
+
+// =====================================================
+// ### SURVIVOR MODE ###
+
+// Link must kill as many monsters as he can
+void SurvivorMode_Enter(uint8_t from){
+    // a wave was finished, go to the next one
+    if(from==STATE_LEVEL){
+        Game_Wait(0);
+        return;
+    }
+
+    Nokia5110_Clear();
+    Game_Wait(430);
+
+    mode = 1;
+    survivor_points = 0;
+    global_life = 6;
+
+    // one seed for the game, the first wave is made now
+    srand(SysTickValueGet());
+    survivor_wave = 0;
+    Wave_Reset();
+    Wave_Plan(survivor_wave);
+}
+
+// Starts the next wave, made while Link walked out of the last one
+uint8_t SurvivorMode_Update(){
+    Level_Load(Wave_Get(survivor_wave++));
+    return STATE_LEVEL;
+}
+
+void SurvivorMode_Exit(uint8_t to){
+}
+
+// Puts the survivor mode score in the high scores
+void SurvivorMode_Score(){
+    if(survivor_points>highscore[0]){
+        highscore[2]=highscore[1];
+        highscore[1]=highscore[0];
+        highscore[0]=survivor_points;
+    }else if(survivor_points>highscore[1]){
+        highscore[2]=highscore[1];
+        highscore[1]=survivor_points;
+    }else if(survivor_points>highscore[2]){
+        highscore[2]=survivor_points;
+    }
+}
+
+// =====================================================
+// ### LEVEL INTERACTIONS ###
+
+// Starts setting a new level, or a cutscene
+// The arena of the last one is given back, and the monsters, projectiles and
+// effects of this one are taken from it, with no monster yet and nothing
+// flying or playing
+Enemies_t *Level_New(void){
+    Enemies_t *enemy;
+
+    Arena_Reset();
+    enemy = Arena_Alloc(sizeof(Enemies_t));   // the first block, it always fits
+    Pool_Init(&enemy_pool, enemy->next, enemy->prev, ENEMIES);
+    enemy->pool = &enemy_pool;
+    Projectile_Reset();
+    Effect_Reset();
+    return enemy;
+}
+
+// Sets the monsters of the next level
+// The level starts when the game enters STATE_LEVEL
+void Level_Set(Enemies_t *queue, uint8_t n_monsters){
+    level.enemy_queue = queue;
+    level.enemy_amount = n_monsters;
+}
+
+// Sets the next level from its record
+// The monsters that come with it are taken from the pools and drawn in one
+// batch, the screen is shown once by Level_Enter with Link and the lifebar.
+// The others come in while it runs (see Level_Arrivals).
+void Level_Load(const Level_Def_t *def){
+    Level_Set(Level_New(), def->kills);
+    level.def = def;
+    level.spawned = 0;
+    level.spawn_wait = 0;
+
+    if(def->spawns && !def->spawn[0].delay) Level_Spawn(level.enemy_queue, 0);
+    else if(def->spawns) level.spawn_wait = def->spawn[0].delay;
+}
+
+// Takes the monsters of the level record that come now from the pools, up to
+// the next one that comes later, and sets how long it waits
+// While the level runs they are put in the collision boxes at once, else
+// Level_Enter does it. A monster the level has no room for isn't waited for.
+// A monster that comes anywhere is put on free cells away from Link; if
+// there are none it and the ones after it try again the next level tick.
+void Level_Spawn(Enemies_t *enemy, bool running){
+    const Level_Def_t *def = level.def;
+    const Level_Spawn_t *spawn;
+    const Archetype_t *archetype;
+    bool grid = 0;              // the planner knows the cells taken in this batch
+    uint8_t x, y;
+    uint8_t m;  // monster index
+
+    while(1){
+        spawn = &def->spawn[level.spawned];
+        x = spawn->x;
+        y = spawn->y;
+        if(x==SPAWN_ANYWHERE){
+            archetype = &enemy_archetype[spawn->type];
+            if(!grid){
+                Level_Occupancy(enemy, running);
+                grid = 1;
+            }
+            if(!Spawn_Pick(archetype->w, archetype->h, &x, &y)){
+                level.spawn_wait = 1;
+                break;
+            }
+            Spawn_Block(x, y, archetype->w, archetype->h);
+        }
+
+        level.spawned++;
+        m = Enemy_New(enemy, spawn->type, x, y);
+        if(m==ENEMY_NONE){
+            if(running) level.link.enemies_to_kill--;
+            else level.enemy_amount--;
+        }else if(running){
+            Level_Place(enemy, m);
+        }
+
+        if(level.spawned==def->spawns || def->spawn[level.spawned].delay){
+            level.spawn_wait = level.spawned<def->spawns ? def->spawn[level.spawned].delay : 0;
+            break;
+        }
+    }
+
+    if(running) Level_Obstacles(enemy);
+}
+
+// Marks the cells of the spawn planner taken by the lifebar, the monsters of
+// the level and Link with room around him, where he stands or will start
+void Level_Occupancy(Enemies_t *enemy, bool running){
+    const Archetype_t *archetype;
+    uint8_t m;  // monster index
+
+    Spawn_Clear();
+    Spawn_Block(0, 7, MAX_X, 8);
+
+    for(m=enemy->pool->first;m!=POOL_NONE;m=enemy->next[m]){
+        archetype = &enemy_archetype[enemy->type[m]];
+        Spawn_Block(enemy->x[m], enemy->y[m], archetype->w, archetype->h);
+    }
+
+    if(running) Spawn_Guard(level.link.x, level.link.y, level.link.size_x, level.link.size_y);
+    else Spawn_Guard(LINK_START_X, LINK_START_Y, LINK_WIDTH, LINK_HEIGHT);
+}
+
+// Monsters of the level that come in late, when their delay is over
+void Level_Arrivals(Enemies_t *enemy){
+    if(!level.def || level.spawned==level.def->spawns) return;
+    if(--level.spawn_wait) return;
+    Level_Spawn(enemy, 1);
+}
+
+// Puts enemy m in the collision boxes, and in the background if it never moves
+void Level_Place(Enemies_t *enemy, uint8_t m){
+    Level_Collide(COLLISION_ENEMY+m, Enemy_Sprite(enemy, m), enemy->x[m], enemy->y[m]);
+    if(!enemy_archetype[enemy->type[m]].period){
+        enemy->flags[m] |= ENEMY_BAKED;
+        Nokia5110_BakeBMP(enemy->x[m], enemy->y[m], Enemy_Sprite(enemy, m));
+    }
+}
+
+// Set a new level
+void Level_Enter(uint8_t from){
+
+    uint8_t m;                  // monster index
+
+    // back from the pause menu, the level goes on
+    // the menu was cleared from the buffer, the screen shows it on the next tick
+    if(from==STATE_PAUSE){
+        level_dirty = 1;
+        return;
+    }
+
+    enemy_tick = 0;
+
+    Collision_Clear();          // no boxes from the last level
+    level.link = Link_New();    // creates a new Link for the level
+    level.link.enemies_to_kill = level.enemy_amount;    // set how many monsters Link must defeat to finish the level
 
-    Nokia5110_PrintBMP(34,8,pausemenu,0);
-    Nokia5110_PrintBMP(54,6,invseta,0);
-    Nokia5110_DisplayBuffer();
-    while(1){
-        switch(GetSwitch(GetButton())){
-            case LEFT:
-                if(i){
-                    Nokia5110_ClearBitmap(71,6,invseta);
-                    i=!i;
-                    Nokia5110_PrintBMP(54,6,invseta,0);
-                    Nokia5110_DisplayBuffer();
-                    SysCtlDelay(SysCtlClockGet() / 10);
-                }
-                break;
+    // put Link in the collision boxes
+    Level_Collide(COLLISION_LINK,level.link.last_sprite,level.link.x,level.link.y);
 
-            case RIGHT:
-                if(!i){
-                    Nokia5110_ClearBitmap(54,6,invseta);
-                    i=!i;
-                    Nokia5110_PrintBMP(71,6,invseta,0);
-                    Nokia5110_DisplayBuffer();
-                    SysCtlDelay(SysCtlClockGet() / 10);
-                }
-                break;
+    Lifebar_Update(global_life);              // set and show up the lifebar on the screen
 
-            case SWORD:
-                SysCtlDelay(SysCtlClockGet()/10);
-                Nokia5110_ClearBitmap(34,8,pausemenu);
-                return i;
-        }
+    // put the current enemies in the collision boxes
+    // the ones that never move are drawn once in the background, and their
+    // boxes stay where they are set here
+    Nokia5110_ClearBackground();
+    for(m=level.enemy_queue->pool->first;m!=POOL_NONE;m=level.enemy_queue->next[m]){
+        Level_Place(level.enemy_queue, m);
     }
-}
 
-// Link must kill as many monsters as he can
-void SurvivorMode(){
-    uint8_t enemy[4]={GRASS,CUCCO,OLDMAN,MADCUCCO};
-    uint8_t boss[2]={GRAND_CUCCO,GRAND_MADCUCCO};
-    uint8_t i;  // simple counter
+    // followers find their way around the static enemies
+    Flow_Reset();
+    Level_Obstacles(level.enemy_queue);
 
-    Nokia5110_Clear();
-    SysCtlDelay(SysCtlClockGet()/7);
+    // the cuccos forget
+    Swarm_Reset();
+    cucco_anger = 0;
+    swarm_peck = 0;
+}
 
-    mode = 1;
-    survivor_points = 0;
-    global_life = 6;
+// One tick of the level
+// returns STATE_GAMEOVER when Link dies, the game mode state when finished
+uint8_t Level_Update(){
 
-    // number of monsters in each level
-    // must be passed as an argument to Level_New
-    uint8_t n;
+    if(level.link.enemies_to_kill){
 
-    uint8_t m;  // kind of monster
-    uint8_t s;  // monster status
+        // change Link's position and attitude
+        if(Link_Move(&(level.link), level.enemy_queue)==PAUSE) return STATE_PAUSE;
 
-    // monster queue
-    Enemy_t queue[5]={0,0,0,0,0};
+        // the monsters that come in late
+        Level_Arrivals(level.enemy_queue);
 
-    // generates random levels at each iteration
-    while(1){
-        srand(SysTickValueGet());
-        n = rand()%4+1;
-        if(n==1){
-            m = rand()%2;
-            s = rand()%2+1;
-            queue[0] = Enemy_New(boss[m],30,40,5*boss[m],1,s);
-        }else{
-            for(i=0;i<n;i++){
-                srand(SysTickValueGet());
-                m = rand()%4;
-                if(m==0) s=0;
-                else s = rand()%2+1;
-                queue[i] = Enemy_New(enemy[m],20+16*i,47-2*(s+1)*i-m,3*enemy[m]+1,1,s);
-            }
+        // change all the enemies position
+        Enemy_Move(&(level.link), level.enemy_queue);
+        Level_Animate(&(level.link), level.enemy_queue);
+        Level_Swarm(&(level.link), level.enemy_queue);
+        Level_Projectiles(&(level.link), level.enemy_queue);
+
+        // then handle what touched what
+        Level_Resolve(&(level.link), level.enemy_queue);
+        Level_Effects(&(level.link), level.enemy_queue);
+
+        // overlap what was drawn with lifebar, and with score if in Survival mode
+        // then show the whole tick at once, a still tick isn't sent
+        if(level_dirty){
+            Lifebar_Update(level.link.life);
+            if(mode) DisplayScore();
         }
-        if(!(Level_New(queue,n))) break;
+        Level_Present();
+
+        if(level.link.life<=0) return STATE_GAMEOVER;
+        return STATE_LEVEL;
     }
 
-    if(survivor_points>highscore[0]){
-        highscore[2]=highscore[1];
-        highscore[1]=highscore[0];
-        highscore[0]=survivor_points;
-    }else if(survivor_points>highscore[1]){
-        highscore[2]=highscore[1];
-        highscore[1]=survivor_points;
-    }else if(survivor_points>highscore[2]){
-        highscore[2]=survivor_points;
+    // level finished animation
+    // the next survivor wave is made while Link walks out
+    if(mode) Wave_Plan(survivor_wave);
+    if(level.link.attack) Link_Sheathe(&(level.link));
+    if(Swarm_Count()) Level_Calm();
+    if(Projectile_First()!=PROJECTILE_NONE) Level_Ceasefire();
+    if(level.link.x<MAX_X){
+        Nokia5110_ClearBitmap(level.link.x,level.link.y,level.link.last_sprite);
+        level.link.x +=2;
+        Animation_Play(&(level.link.animation), CLIP_TROT);
+        Animation_Step(&(level.link.animation));
+        level.link.last_sprite = link_array[WALKING+level.link.animation.pose][RIGHT];
+        Nokia5110_PrintBMP(level.link.x,level.link.y,level.link.last_sprite,0);
+
+        // the last defeat plays on while Link leaves
+        Level_Effects(&(level.link), level.enemy_queue);
+        Nokia5110_DisplayBuffer();
+        Game_Wait(85);
+        return STATE_LEVEL;
     }
 
+    global_life = level.link.life;
     Nokia5110_Clear();
-    Nokia5110_ClearBuffer();
-    return;
-}
 
-// Put the number of killed enemies on screen
-void DisplayScore(){
-    int d1,d2;
+    if(mode) return STATE_SURVIVOR;
+    return STATE_CAMPAIGN;
+}
 
-    d2 = survivor_points%10;
-    d1 = survivor_points/10;
+// The background of the level is kept for the pause menu only
+void Level_Exit(uint8_t to){
+    if(to!=STATE_PAUSE) Nokia5110_ClearBackground();
+}
 
-    Nokia5110_PrintBMP(73,7,blackseta,0);
-    Nokia5110_PrintBMP(73,5,blackseta,0);
-    Nokia5110_PrintBMP(74,7,number[d1],0);
-    Nokia5110_PrintBMP(78,7,number[d2],0);
+// Shows the buffer on the screen once a tick, if something was drawn in it
+// The level subsystems only draw in the buffer and set level_dirty
+void Level_Present(void){
+    if(!level_dirty) return;
     Nokia5110_DisplayBuffer();
+    level_dirty = 0;
 }
 
-// =====================================================
-// ### LEVEL INTERACTIONS ###
+// Puts Link or an enemy in the collision boxes and records what it hits
+// The hits are handled by Level_Resolve once everything has moved
+void Level_Collide(uint8_t id, const unsigned char *sprite, uint8_t x, uint8_t y){
+    Collision_Set(id, x, y, sprite);
+    Level_Touch(id);
+}
 
-// Set a new level
-// returns 1 when finished, 0 when GameOver
-bool Level_New(Enemy_t *queue, uint8_t n_monsters){
+// Records what the box of id touches
+void Level_Touch(uint8_t id){
+    uint8_t hit;    // collision id of what was hit
 
-    uint8_t n;                  // index for the enemies
-    Level_WarMapStart(warmap);  // Initialize the warmap
-    Level_t level;              // creates a new level
-    level.link = Link_New();    // creates a new Link for the level
-    level.link.enemies_to_kill = n_monsters;    // set how many monsters Link must defeat to finish the level
+    switch(id){
 
-    // put Link in the warmap
-    Level_WarMapUpdate(&(level.link),level.enemy_queue,level.link.last_sprite,level.link.x,level.link.y,LINK);
+        case COLLISION_LINK:
+            hit = Collision_Check(id, COLLISION_ENEMY, COLLISION_BOXES);
+            if(hit!=COLLISION_NONE) Collision_Post(id, hit);
+            break;
 
-    Lifebar_Update(global_life);              // set and show up the lifebar on the screen
-    level.enemy_amount = n_monsters; // how many monsters in the level
-    level.enemy_queue = queue;  // set the enemy queue to the level
+        // every enemy under the sword
+        case COLLISION_SWORD:
+            hit = Collision_Check(id, COLLISION_ENEMY, COLLISION_BOXES);
+            while(hit!=COLLISION_NONE){
+                Collision_Post(id, hit);
+                hit = Collision_Check(id, hit+1, COLLISION_BOXES);
+            }
+            break;
 
-    // update the warmap with current enemies position
-    for(n=0;n<n_monsters;n++){
-        Level_WarMapUpdate(&(level.link),level.enemy_queue,level.enemy_queue[n].last_sprite,level.enemy_queue[n].x,level.enemy_queue[n].y,ENEMY);
+        // an enemy, it may step into Link or into the sword
+        default:
+            if(Collision_Check(id, COLLISION_LINK, COLLISION_LINK+1)!=COLLISION_NONE) Collision_Post(COLLISION_LINK, id);
+            if(Collision_Check(id, COLLISION_SWORD, COLLISION_SWORD+1)!=COLLISION_NONE) Collision_Post(COLLISION_SWORD, id);
+            break;
     }
+}
 
-    // the level will run inside this loop
-    while(level.link.enemies_to_kill){
+// Handles the hits of the tick, in a fixed order
+// The sword and beam hits go first, so a defeated enemy doesn't hurt Link
+// anymore, then the first enemy still touching Link hurts him and pushes him
+// back, and last a swarm peck and a feather, one of each a tick at most.
+// Hits made by the push back are handled in the next tick.
+void Level_Resolve(Link_t *link, Enemies_t *enemy){
+    Collision_Event_t event;
+    uint8_t m;                      // monster index
+    uint8_t hurt = ENEMY_NONE;      // first enemy touching Link
+    bool pecked = 0;                // a swarm cucco pecked Link
+    bool shot = 0;                  // a feather hit Link
+
+    while(Collision_Take(&event)){
+        if(event.id==COLLISION_PECK){
+            pecked = 1;
+            continue;
+        }
+        if(event.id==COLLISION_FEATHER){
+            shot = 1;
+            continue;
+        }
 
-        // change Link's position and attitude
-        // Link is not in the warmap until it moves or attacks
-        Link_Move(&(level.link), level.enemy_queue);
-        SysCtlDelay(SysCtlClockGet() / 40);
+        m = event.hit - COLLISION_ENEMY;
+        if(!(enemy->flags[m] & ENEMY_ALIVE)) continue;
+        if(event.id==COLLISION_SWORD){
+            // an enemy is hit once in a swing
+            if(!(enemy->flags[m] & ENEMY_STRUCK)){
+                enemy->flags[m] |= ENEMY_STRUCK;
+                Link_Attack(link,enemy,m);
+            }
+        }else if(event.id==COLLISION_BEAM){
+            Link_Attack(link,enemy,m);
+        }else{
+            enemy->flags[m] |= ENEMY_TOUCHED;
+        }
+    }
 
-        // change all the enemies position
-        Enemy_Move(&(level.link), level.enemy_queue);
+    for(m=enemy->pool->first;m!=POOL_NONE;m=enemy->next[m]){
+        if((enemy->flags[m] & ENEMY_TOUCHED) && hurt==ENEMY_NONE) hurt = m;
+        enemy->flags[m] &= ~ENEMY_TOUCHED;
+    }
+    if(hurt!=ENEMY_NONE) Link_IsAttacked(link,enemy,hurt);    // link loses life
+    if(pecked) Link_LifeLoss(link,1);
+    if(shot) Link_LifeLoss(link,1);
+}
 
-        // overlap the screen with lifebar
-        Lifebar_Update(level.link.life);
+// Static enemies are obstacles for the followers
+void Level_Obstacles(Enemies_t *enemy){
+    const Archetype_t *archetype;   // stats of the monster
+    uint8_t m;  // monster index
 
-        // show score if in Survival mode
-        if(mode) DisplayScore();
+    Flow_Clear();
+    for(m=enemy->pool->first;m!=POOL_NONE;m=enemy->next[m]){
+        if((enemy->flags[m] & ENEMY_STATUS)==DUMB){
+            archetype = &enemy_archetype[enemy->type[m]];
+            Flow_Block(enemy->x[m], enemy->y[m], archetype->w, archetype->h);
+        }
+    }
+}
 
-        if(level.link.life<=0) return 0;
+// Steps the animations of Link and of every enemy a tick, apart from their
+// moves, and draws again the ones whose step changed
+void Level_Animate(Link_t *link, Enemies_t *enemy){
+    const Archetype_t *archetype;   // stats of a monster
+    uint8_t m;                      // monster index
+    bool link_erased = 0;           // an enemy was drawn over Link
+
+    for(m=enemy->pool->first;m!=POOL_NONE;m=enemy->next[m]){
+        if(enemy->flags[m] & ENEMY_BAKED) continue;
+        if(!Animation_Step(&enemy->animation[m])) continue;
+
+        archetype = &enemy_archetype[enemy->type[m]];
+        Nokia5110_PrintBMP(enemy->x[m], enemy->y[m], Enemy_Sprite(enemy, m), 0);
+        Level_Collide(COLLISION_ENEMY+m, Enemy_Sprite(enemy, m), enemy->x[m], enemy->y[m]);
+        level_dirty = 1;
+        if(Collision_Overlaps(enemy->x[m], enemy->y[m], archetype->w, archetype->h,
+                              link->x, link->y, link->size_x, link->size_y)){
+            link_erased = 1;
+        }
     }
 
-    // level finished animation
-    while(level.link.x<MAX_X){
-        Nokia5110_ClearBitmap(level.link.x,level.link.y,level.link.sprite[WALKING+level.link.step][RIGHT]);
-        level.link.x +=2;
-        level.link.step = !level.link.step;
-        Nokia5110_PrintBMP(level.link.x,level.link.y,level.link.sprite[WALKING+level.link.step][RIGHT],0);
-        Nokia5110_DisplayBuffer();
-        SysCtlDelay(SysCtlClockGet() / 35);
+    // the sword swing has a sprite of its own
+    if(!link->attack && Animation_Step(&link->animation)){
+        link->last_sprite = link_array[WALKING+link->animation.pose][link->direction];
+        Level_Collide(COLLISION_LINK, link->last_sprite, link->x, link->y);
+        link_erased = 1;
     }
+    if(link_erased){
+        Nokia5110_PrintBMP(link->x, link->y, link->attack ? link_array[ATTACKING][link->direction] : link->last_sprite, 0);
+        level_dirty = 1;
+    }
+}
 
-    global_life = level.link.life;
-    Nokia5110_Clear();
-    return 1;
+// A new swing of the sword, every enemy can be hit again
+void Level_Unstrike(Enemies_t *enemy){
+    uint8_t m;  // monster index
+
+    for(m=enemy->pool->first;m!=POOL_NONE;m=enemy->next[m]) enemy->flags[m] &= ~ENEMY_STRUCK;
 }
 
-// Creates the warmap for the level
-void Level_WarMapStart(uint8_t warmap[48][84]){
-    uint8_t i,j;
-    for(i=0;i<48;i++){
-        for(j=0;j<84;j++){
-            warmap[i][j] = 0;
+// Something w x h at (x, y) was erased, the enemies it was over are marked
+// ENEMY_ERASED to be drawn again by Level_Redraw
+// The baked ones were put back from the background by the erase
+// Returns 1 if it was over Link
+bool Level_Under(Link_t *link, Enemies_t *enemy, uint8_t x, uint8_t y, uint8_t w, uint8_t h){
+    const Archetype_t *archetype;   // stats of a monster
+    uint8_t m;  // monster index
+
+    for(m=enemy->pool->first;m!=POOL_NONE;m=enemy->next[m]){
+        if(enemy->flags[m] & ENEMY_BAKED) continue;
+        archetype = &enemy_archetype[enemy->type[m]];
+        if(Collision_Overlaps(x, y, w, h, enemy->x[m], enemy->y[m], archetype->w, archetype->h)){
+            enemy->flags[m] |= ENEMY_ERASED;
         }
     }
+    return Collision_Overlaps(x, y, w, h, link->x, link->y, link->size_x, link->size_y);
 }
 
-// Updates the warmap when Link moves
-void Level_WarMapUpdate(Link_t *link, Enemy_t *enemy, const unsigned char *sprite, uint8_t x, uint8_t y, uint8_t value){
-    uint8_t i,j;    // index to make through the warmap
-    uint8_t m;      // actual enemy index
-    uint8_t dx = Nokia5110_getWidth(sprite);    // return horizontal sprite size
-    uint8_t dy = Nokia5110_getHeight(sprite);   // return vertical sprite size
+// Draws again the enemies marked ENEMY_ERASED, and Link if link_erased
+void Level_Redraw(Link_t *link, Enemies_t *enemy, bool link_erased){
+    uint8_t m;  // monster index
 
-    uint8_t status = FREE;  // current status will start as free (no objects in the spot)
+    if(link_erased) Nokia5110_PrintBMP(link->x, link->y, link->last_sprite, 0);
+    for(m=enemy->pool->first;m!=POOL_NONE;m=enemy->next[m]){
+        if(!(enemy->flags[m] & ENEMY_ERASED)) continue;
+        enemy->flags[m] &= ~ENEMY_ERASED;
+        Nokia5110_PrintBMP(enemy->x[m], enemy->y[m], Enemy_Sprite(enemy, m), 0);
+    }
+}
 
-    // walk through the warmap inside the sprite coordinates
-    for(i = y; i > y-dy ; i--){
-        for(j = x; j < x+dx; j++){
-            warmap[i][j] += value;  // add the character value to the warmap
-            // change the status if the result is one of the status options
-            if(warmap[i][j]==LOSE){
-                status = LOSE;
-            }
-            if(warmap[i][j]==WIN){
-                status = WIN;
-            }
+// Takes baked enemy m out of the background and off the screen
+// The baked enemies it was over are drawn in the background again
+void Level_Unbake(Enemies_t *enemy, uint8_t m){
+    const Archetype_t *archetype = &enemy_archetype[enemy->type[m]];
+    const Archetype_t *other;       // stats of another monster
+    uint8_t k;  // other monster index
+
+    Nokia5110_UnbakeBitmap(enemy->x[m], enemy->y[m], Enemy_Sprite(enemy, m));
+    for(k=enemy->pool->first;k!=POOL_NONE;k=enemy->next[k]){
+        if(k==m || !(enemy->flags[k] & ENEMY_BAKED)) continue;
+        other = &enemy_archetype[enemy->type[k]];
+        if(Collision_Overlaps(enemy->x[m], enemy->y[m], archetype->w, archetype->h,
+                              enemy->x[k], enemy->y[k], other->w, other->h)){
+            Nokia5110_BakeBMP(enemy->x[k], enemy->y[k], Enemy_Sprite(enemy, k));
         }
     }
+    Nokia5110_ClearBitmap(enemy->x[m], enemy->y[m], Enemy_Sprite(enemy, m));
+    enemy->flags[m] &= ~ENEMY_BAKED;
+}
 
-    // check the final status
-    switch(status){
+// Cucco revenge
+// Once the cuccos hit in the level are angry enough, a swarm flies in from
+// the top and bottom borders, a cucco every 4 ticks, and pecks Link every
+// SWARM_PECK ticks. The sword can't stop it, Link must finish the level.
+void Level_Swarm(Link_t *link, Enemies_t *enemy){
+    uint8_t i;              // cucco index
+    uint8_t x, y;           // cucco position
+    bool link_erased = 0;   // a cucco was drawn over Link
 
-        case LOSE:
-            m = Level_WarMapCheckEnemy(enemy,status); // discover which enemy attacked Link
-            Link_IsAttacked(link,&enemy[m]);          // link loses life
-            break;
+    if(cucco_anger < SWARM_ANGER) return;
 
-        case WIN:
-            m = Level_WarMapCheckEnemy(enemy,status); // discover which enemy Link attacked
-            Link_Attack(link,&enemy[m]);
-            // Level_WarMapUpdate(link, enemy, link->last_sprite, link->x, link->y, LINK);
-            break;
+    if(Swarm_Count() < SWARM_AGENTS && !(enemy_tick % 4)){
+        y = (enemy_tick & 4) ? SWARM_HEIGHT - 1 : MAX_Y - 1;
+        Swarm_Add(rand() % (MAX_X - SWARM_WIDTH), y);
+    }
 
-        default: break;
+    // erase the swarm, and find who was under it
+    for(i=0;i<Swarm_Count();i++){
+        Swarm_Position(i, &x, &y);
+        Nokia5110_ClearBitmap(x, y, swarm_sprite[0]);
+        if(Level_Under(link, enemy, x, y, SWARM_WIDTH, SWARM_HEIGHT)) link_erased = 1;
     }
-}
 
-// Clears the warmap
-void Level_WarMapClear(const unsigned char *sprite, uint8_t x, uint8_t y, uint8_t value){
-    uint8_t i,j;
-    uint8_t dx = Nokia5110_getWidth(sprite);
-    uint8_t dy = Nokia5110_getHeight(sprite);
+    Swarm_Update(link->x + link->size_x/2 - SWARM_WIDTH/2, link->y - link->size_y/2 + SWARM_HEIGHT/2);
+
+    Level_Redraw(link, enemy, link_erased);
 
-    for(i = y; i > y-dy ; i--){
-        for(j = x; j < x+dx; j++){
-            warmap[i][j]-=value;
+    // draw it again, flapping, and peck
+    if(swarm_peck) swarm_peck--;
+    for(i=0;i<Swarm_Count();i++){
+        Swarm_Position(i, &x, &y);
+        Nokia5110_PrintBMP(x, y, swarm_sprite[(enemy_tick + i) & 1], 0);
+
+        if(!swarm_peck &&
+           Collision_Overlaps(x, y, SWARM_WIDTH, SWARM_HEIGHT, link->x, link->y, link->size_x, link->size_y)){
+            swarm_peck = SWARM_PECK;
+            Swarm_Repel(i, link->x + link->size_x/2, link->y - link->size_y/2);
+            Collision_Post(COLLISION_PECK, COLLISION_LINK);
         }
     }
+    if(Swarm_Count()) level_dirty = 1;
 }
 
-// Returns which monster is being attacked or attacking
-uint8_t Level_WarMapCheckEnemy(Enemy_t *enemy, uint8_t status){
-    uint8_t i,j;
-    uint8_t m=0; // monster index
+// The swarm flies away and the cuccos forget
+void Level_Calm(void){
+    uint8_t i;              // cucco index
+    uint8_t x, y;           // cucco position
 
-    // there will be no more than 6 enemies at a level
-    for(m=0;m<6;m++){
-        for(i=enemy[m].x; i<=enemy[m].x+enemy[m].size_x; i++){
-            for(j=enemy[m].y; j>enemy[m].y-enemy[m].size_y; j--){
-                if(warmap[j][i]==status){
-                    return m;
-                }
+    for(i=0;i<Swarm_Count();i++){
+        Swarm_Position(i, &x, &y);
+        Nokia5110_ClearBitmap(x, y, swarm_sprite[0]);
+    }
+    level_dirty = 1;
+
+    Swarm_Reset();
+    cucco_anger = 0;
+}
+
+// Sword beams and feathers
+// All of them are erased, moved in one batch and drawn again. Whoever fires
+// one draws it, so each tick erases what the last one drew. A beam strikes
+// the first enemy it touches like the sword, a feather takes a heart from
+// Link, and either is gone once it hits.
+void Level_Projectiles(Link_t *link, Enemies_t *enemy){
+    const unsigned char *sprite;    // sprite of a projectile
+    uint8_t p, next;        // projectile indexes
+    uint8_t x, y;           // projectile position
+    uint8_t hit;            // collision id of what was hit
+    bool link_erased = 0;   // a projectile was drawn over Link
+
+    if(Projectile_First()==PROJECTILE_NONE) return;
+
+    // erase them, and find who was under them
+    for(p=Projectile_First();p!=PROJECTILE_NONE;p=Projectile_Next(p)){
+        Projectile_Position(p, &x, &y);
+        sprite = Projectile_Sprite(p);
+        Nokia5110_ClearBitmap(x, y, sprite);
+        if(Level_Under(link, enemy, x, y, Nokia5110_getWidth(sprite), Nokia5110_getHeight(sprite))) link_erased = 1;
+    }
+
+    Projectile_Update();
+
+    Level_Redraw(link, enemy, link_erased);
+
+    // hit or draw
+    for(p=Projectile_First();p!=PROJECTILE_NONE;p=next){
+        next = Projectile_Next(p);
+        Projectile_Position(p, &x, &y);
+        sprite = Projectile_Sprite(p);
+
+        if(Projectile_Owner(p)==PROJECTILE_LINK){
+            hit = Collision_Query(sprite, x, y, COLLISION_ENEMY, COLLISION_BOXES);
+            if(hit!=COLLISION_NONE){
+                Projectile_Kill(p);
+                Collision_Post(COLLISION_BEAM, hit);
+                continue;
             }
+        }else if(Collision_Query(sprite, x, y, COLLISION_LINK, COLLISION_LINK+1)!=COLLISION_NONE){
+            Projectile_Kill(p);
+            Effect_Play(x, y, spark, 0, 1, SPARK_TICKS, 0, 0);
+            Collision_Post(COLLISION_FEATHER, COLLISION_LINK);
+            continue;
         }
+        Nokia5110_PrintBMP(x, y, sprite, 0);
+    }
+    level_dirty = 1;
+}
+
+// Defeats, sparks and lost feathers
+// The effects are erased, aged in one batch and drawn again over what is
+// under them, so a defeat doesn't stop the game while it plays. Only the
+// oldest EFFECT_DRAWS are drawn in a tick; as they are the oldest, they are
+// also the ones drawn in the last tick.
+void Level_Effects(Link_t *link, Enemies_t *enemy){
+    const unsigned char *sprite;    // frame of an effect
+    uint8_t e, n;           // effect index, and effects drawn
+    uint8_t x, y;           // effect position
+    bool link_erased = 0;   // an effect was drawn over Link
+
+    if(Effect_First()==EFFECT_NONE) return;
+
+    // erase them, and find who was under them
+    for(e=Effect_First(), n=0;e!=EFFECT_NONE && n<EFFECT_DRAWS;e=Effect_Next(e), n++){
+        Effect_Position(e, &x, &y);
+        sprite = Effect_Sprite(e);
+        Nokia5110_ClearBitmap(x, y, sprite);
+        if(Level_Under(link, enemy, x, y, Nokia5110_getWidth(sprite), Nokia5110_getHeight(sprite))) link_erased = 1;
     }
 
-    return 99;
+    Effect_Update();
+
+    Level_Redraw(link, enemy, link_erased);
+
+    for(e=Effect_First(), n=0;e!=EFFECT_NONE && n<EFFECT_DRAWS;e=Effect_Next(e), n++){
+        Effect_Position(e, &x, &y);
+        Nokia5110_OrBMP(x, y, Effect_Sprite(e));
+    }
+    level_dirty = 1;
+}
+
+// Every projectile falls
+void Level_Ceasefire(void){
+    uint8_t p, next;        // projectile indexes
+    uint8_t x, y;           // projectile position
+
+    for(p=Projectile_First();p!=PROJECTILE_NONE;p=next){
+        next = Projectile_Next(p);
+        Projectile_Position(p, &x, &y);
+        Nokia5110_ClearBitmap(x, y, Projectile_Sprite(p));
+        Projectile_Kill(p);
+    }
+    level_dirty = 1;
 }
 
 
@@ -932,33 +1652,44 @@ uint8_t Level_WarMapCheckEnemy(Enemy_t *enemy, uint8_t status){
 // Creates a hero at the center of the display
 Link_t Link_New(){
     Link_t hero;
-    hero.x = 1;
-    hero.y = 33;
-    hero.sprite[0] = link_attack;
-    hero.sprite[1] = link_walk_1;
-    hero.sprite[2] = link_walk_2;
+    hero.x = LINK_START_X;
+    hero.y = LINK_START_Y;
     hero.last_sprite = link_walk_1[RIGHT];
-    hero.sword = sword_sprite[RIGHT];
-    hero.size_x = 14;
-    hero.size_y = 16;
+    hero.sword = 0;
+    hero.size_x = LINK_WIDTH;
+    hero.size_y = LINK_HEIGHT;
     hero.life = global_life;
     hero.status = WALKING;
-    hero.step = 0;
+    Animation_Start(&hero.animation, CLIP_STILL);
     hero.direction = RIGHT;
+    hero.attack = 0;
 
+    // the level shows the screen once it is all drawn
     Nokia5110_PrintBMP(hero.x, hero.y,hero.last_sprite,0);
-    Nokia5110_DisplayBuffer();
 
     return hero;
 }
 
 // Change the hero position and sprite
-void Link_Move(Link_t *link, Enemy_t *enemy){
-    switch(GetSwitch(GetButton())){
+// returns the switch that was handled
+uint8_t Link_Move(Link_t *link, Enemies_t *enemy){
+    uint8_t sw;
+
+    // an attack goes on until its last frame, the switches wait
+    if(link->attack){
+        Link_Swing(link);
+        return SWORD;
+    }
+
+    sw = GetSwitch(GetButton());
+
+    // Link walks while a direction is held, and stands on his first step
+    Animation_Play(&link->animation, sw<=LEFT ? CLIP_TROT : CLIP_STILL);
+
+    switch(sw){
         case UP:
             Nokia5110_ClearBitmap(link->x,link->y,link->last_sprite);
-            Level_WarMapClear(link->last_sprite, link->x, link->y, LINK);
-            Nokia5110_DisplayBuffer();
+            Collision_Remove(COLLISION_LINK);
 
             // change Link position if it is not in the screen border
             if(link->y > link->size_y + 2) link->y-=2;
@@ -967,180 +1698,238 @@ void Link_Move(Link_t *link, Enemy_t *enemy){
 
             link->direction = UP; // change Link's direction
             // updates Link last sprite
-            link->last_sprite = link->sprite[WALKING+link->step][link->direction];
+            link->last_sprite = link_array[WALKING+link->animation.pose][link->direction];
             Nokia5110_PrintBMP(link->x,link->y,link->last_sprite,0);
-            Nokia5110_DisplayBuffer();
-            link->step = !(link->step); // alternate Link step for sprite animation
-            Level_WarMapUpdate(link, enemy, link->last_sprite, link->x, link->y, LINK);
+            Level_Collide(COLLISION_LINK, link->last_sprite, link->x, link->y);
+            level_dirty = 1;
             break;
 
         case RIGHT:
             Nokia5110_ClearBitmap(link->x,link->y,link->last_sprite);
-            Level_WarMapClear(link->last_sprite, link->x, link->y, LINK);
-            Nokia5110_DisplayBuffer();
+            Collision_Remove(COLLISION_LINK);
 
             if(link->x < MAX_X - link->size_x - 2) link->x+=2;
             else link->x = MAX_X - link->size_x - 1;
 
             link->direction = RIGHT;
-            link->last_sprite = link->sprite[WALKING+link->step][link->direction];
+            link->last_sprite = link_array[WALKING+link->animation.pose][link->direction];
             Nokia5110_PrintBMP(link->x,link->y,link->last_sprite,0);
-            Nokia5110_DisplayBuffer();
-            link->step = !(link->step);
-            Level_WarMapUpdate(link, enemy, link->last_sprite, link->x, link->y, LINK);
+            Level_Collide(COLLISION_LINK, link->last_sprite, link->x, link->y);
+            level_dirty = 1;
             break;
 
         case DOWN:
             Nokia5110_ClearBitmap(link->x,link->y,link->last_sprite);
-            Level_WarMapClear(link->last_sprite, link->x, link->y, LINK);
-            Nokia5110_DisplayBuffer();
+            Collision_Remove(COLLISION_LINK);
 
             if(link->y < MAX_Y - 2) link->y+=2;
             else link->y = MAX_Y - 1;
 
             link->direction = DOWN;
-            link->last_sprite = link->sprite[WALKING+link->step][link->direction];
+            link->last_sprite = link_array[WALKING+link->animation.pose][link->direction];
             Nokia5110_PrintBMP(link->x,link->y,link->last_sprite,0);
-            Nokia5110_DisplayBuffer();
-            link->step = !(link->step);
-            Level_WarMapUpdate(link, enemy, link->last_sprite, link->x, link->y, LINK);
+            Level_Collide(COLLISION_LINK, link->last_sprite, link->x, link->y);
+            level_dirty = 1;
             break;
 
         case LEFT:
             Nokia5110_ClearBitmap(link->x,link->y,link->last_sprite);
-            Level_WarMapClear(link->last_sprite, link->x, link->y, LINK);
-            Nokia5110_DisplayBuffer();
+            Collision_Remove(COLLISION_LINK);
 
             if(link->x >= 2) link->x-=2;
             else link->x = 0;
 
             link->direction = LEFT;
-            link->last_sprite = link->sprite[WALKING+link->step][link->direction];
+            link->last_sprite = link_array[WALKING+link->animation.pose][link->direction];
             Nokia5110_PrintBMP(link->x,link->y,link->last_sprite,0);
-            Nokia5110_DisplayBuffer();
-            link->step = !(link->step);
-            Level_WarMapUpdate(link, enemy, link->last_sprite, link->x, link->y, LINK);
+            Level_Collide(COLLISION_LINK, link->last_sprite, link->x, link->y);
+            level_dirty = 1;
             break;
 
         case SWORD:
-            Nokia5110_ClearBitmap(link->x,link->y,link->last_sprite);
+            Link_Swing(link);
+            break;
+        // the level goes to the pause menu
+        case PAUSE:
+        default: break;
+    }
+    return sw;
+}
 
-            switch(link->direction){
-                case UP:
-                    if(link->y < 24){
-                        link->sword = 0;
-                    }else if(link->y < 30){
-                        link->sword = sword_half_sprite[UP];
-                    }else{
-                        link->sword = sword_sprite[UP];
-                    }
-                    break;
-                case RIGHT:
-                    if(link->x > 60){
-                        link->sword = 0;
-                    }else if(link->x > 53){
-                        link->sword = sword_half_sprite[RIGHT];
-                    }else{
-                        link->sword = sword_sprite[RIGHT];
-                    }
-                    break;
-                case DOWN:
-                    if(link->y > 39){
-                        link->sword = 0;
-                    }else if(link->y > 32){
-                        link->sword = sword_half_sprite[DOWN];
-                        sword_position_y[DOWN] = 8;
-                    }else{
-                        link->sword = sword_sprite[DOWN];
-                        sword_position_y[DOWN] = 15;
-                    }
-                    break;
-                case LEFT:
-                    if(link->x < 10){
-                        link->sword = 0;
-                    }else if(link->x < 16){
-                        link->sword = sword_half_sprite[LEFT];
-                        sword_position_x[LEFT] = -10;
-                    }else{
-                        link->sword = sword_sprite[LEFT];
-                        sword_position_x[LEFT] = -16;
-                    }
-                    break;
-            }
-            Nokia5110_DisplayBuffer();
+// Shows the next frame of Link's attack, one for each level tick
+// The hitbox covers the sword of this frame and of the last one, so an enemy
+// can't step through the blade between two frames
+void Link_Swing(Link_t *link){
+    uint8_t d = link->direction;
+    uint8_t f;                          // sword frame drawn
+    const Hitbox_t *now, *last;         // hitboxes of this frame and the last one
+    int16_t left, right, top, bottom;   // swept hitbox on the screen
+
+    // the last frame was shown
+    if(link->attack==SWORD_FRAMES){
+        Link_Sheathe(link);
+        Link_Beam(link);
+        level_dirty = 1;
+        return;
+    }
 
-            // first we put the sword on the screen if it fits in
-            Nokia5110_PrintBMP(link->x+sword_position_x[link->direction],link->y+sword_position_y[link->direction],link->sword,0);
-            // then we make Link appear.
-            // this way Link pixels overlap the sword making a best animation effect
-            Nokia5110_PrintBMP(link->x,link->y,link->sprite[ATTACKING][link->direction],0);
+    // Link walking goes away on the first frame, the last sword on the others
+    if(!link->attack){
+        Nokia5110_ClearBitmap(link->x,link->y,link->last_sprite);
+        Level_Unstrike(level.enemy_queue);
+    }else if(link->sword){
+        f = Link_SwordFrame(link, link->attack-1);
+        Nokia5110_ClearBitmap(link->x+sword_box[f][d].x,link->y+sword_box[f][d].y,link->sword);
+    }
 
-            Nokia5110_DisplayBuffer();
-            SysCtlDelay(SysCtlClockGet() / 25);
+    // first we put the sword on the screen if it fits in
+    link->sword = 0;
+    f = Link_SwordFrame(link, link->attack);
+    if(f<SWORD_FRAMES){
+        link->sword = sword_frame_sprite[f][d];
+        Nokia5110_PrintBMP(link->x+sword_box[f][d].x,link->y+sword_box[f][d].y,link->sword,0);
+    }
+    // then we make Link appear.
+    // this way Link pixels overlap the sword making a best animation effect
+    Nokia5110_PrintBMP(link->x,link->y,link_array[ATTACKING][d],0);
+    level_dirty = 1;
+
+    // the hitbox from the last frame to this one, inside the screen
+    now = &sword_box[link->attack][d];
+    last = link->attack ? &sword_box[link->attack-1][d] : now;
+
+    left = now->x < last->x ? now->x : last->x;
+    right = now->x + now->w > last->x + last->w ? now->x + now->w : last->x + last->w;
+    bottom = now->y > last->y ? now->y : last->y;
+    top = now->y - now->h < last->y - last->h ? now->y - now->h : last->y - last->h;
+
+    left += link->x;
+    right += link->x;
+    bottom += link->y;
+    top += link->y;
+
+    if(left < 0) left = 0;
+    if(right > MAX_X) right = MAX_X;
+    if(bottom > MAX_Y - 1) bottom = MAX_Y - 1;
+    if(top < -1) top = -1;
+
+    if(left < right && top < bottom){
+        Collision_SetBox(COLLISION_SWORD, left, bottom, right - left, bottom - top);
+        Level_Touch(COLLISION_SWORD);
+    }else{
+        Collision_Remove(COLLISION_SWORD);
+    }
 
-            // clear sword bitmap on the screen
-            Nokia5110_ClearBitmap(link->x+sword_position_x[link->direction],link->y+sword_position_y[link->direction],link->sword);
-            Nokia5110_PrintBMP(link->x,link->y,link->last_sprite,0);
+    link->attack++;
+}
 
-            Nokia5110_DisplayBuffer();
+// Puts the sword away and shows Link walking again
+void Link_Sheathe(Link_t *link){
+    uint8_t d = link->direction;
+    uint8_t f;
 
-            // update the warmap for the sword
-            Level_WarMapUpdate(link,enemy,link->sword,link->x+sword_position_x[link->direction],link->y+sword_position_y[link->direction],SWORD);
+    if(link->sword){
+        f = Link_SwordFrame(link, link->attack-1);
+        Nokia5110_ClearBitmap(link->x+sword_box[f][d].x,link->y+sword_box[f][d].y,link->sword);
+        link->sword = 0;
+    }
+    Nokia5110_ClearBitmap(link->x,link->y,link_array[ATTACKING][d]);
+    Nokia5110_PrintBMP(link->x,link->y,link->last_sprite,0);
 
-            // clear the warmap for the sword
-            Level_WarMapClear(link->sword,link->x+sword_position_x[link->direction],link->y+sword_position_y[link->direction],SWORD);
+    Collision_Remove(COLLISION_SWORD);
+    link->attack = 0;
+}
 
-            break;
-        case PAUSE:
-            if(!Pause()){
-                link->life=0;
-                Link_IsDead(link);
-            };
-        default: break;
+// With full life, a swing ends shooting a beam where the half sword was
+// There is one beam at a time
+void Link_Beam(Link_t *link){
+    uint8_t d = link->direction;
+    int16_t x = link->x + sword_box[0][d].x;
+    int16_t y = link->y + sword_box[0][d].y;
+
+    if(link->life!=LINK_LIFE || Projectile_Count(PROJECTILE_LINK)) return;
+    if(x < 0 || y < 0) return;
+
+    if(Projectile_Fire(PROJECTILE_LINK, sword_half_sprite[d], x, y,
+                       enemy_dx[d]*BEAM_SPEED, enemy_dy[d]*BEAM_SPEED, BEAM_LIFE)!=PROJECTILE_NONE){
+        Nokia5110_PrintBMP(x, y, sword_half_sprite[d], 0);
     }
 }
 
-// Set the hero to attack mode
-void Link_Attack(Link_t *link, Enemy_t *enemy){
-
-    Nokia5110_ClearBitmap(enemy->x,enemy->y,enemy->last_sprite);
-    Nokia5110_DisplayBuffer();
+// Sword frame drawn at an attack frame, the longest one up to it that fits in the screen
+// Returns SWORD_FRAMES if none fits
+uint8_t Link_SwordFrame(Link_t *link, uint8_t frame){
+    const Hitbox_t *box;
+    int16_t x, y;
+    uint8_t f = frame + 1;
+
+    while(f--){
+        box = &sword_box[f][link->direction];
+        x = link->x + box->x;
+        y = link->y + box->y;
+        if(x >= 0 && x + box->w <= MAX_X && y >= box->h - 1 && y < MAX_Y) return f;
+    }
+    return SWORD_FRAMES;
+}
 
-    enemy->life--;
-    if(!enemy->life){
-        enemy->status = DUMB;
+// Set the hero to attack mode
+// The hit enemy shows a spark, and a defeated one its defeat frames, as
+// effects that play on while the game goes on
+void Link_Attack(Link_t *link, Enemies_t *enemy, uint8_t m){
+    const Archetype_t *archetype = &enemy_archetype[enemy->type[m]];
+    uint8_t step = enemy->animation[m].pose;                // walking step of the defeat frames
+    uint8_t x = enemy->x[m] + archetype->w/2 - Nokia5110_getWidth(spark)/2;
+    uint8_t y = enemy->y[m] - archetype->h/2 + Nokia5110_getHeight(spark)/2;
+
+    enemy->hp[m]--;
+
+    // a baked enemy stays in the background until it is cut down
+    if(!(enemy->flags[m] & ENEMY_BAKED)) Nokia5110_ClearBitmap(enemy->x[m],enemy->y[m],Enemy_Sprite(enemy, m));
+    else if(!enemy->hp[m]) Level_Unbake(enemy, m);
+    level_dirty = 1;
+
+    // hit the cuccos too often and they take revenge
+    // each hit costs them a feather
+    cucco_anger += archetype->anger;
+    if(archetype->anger) Effect_Play(x, enemy->y[m] - archetype->h/2, feather, 0, FEATHER_FALL, 2, rand()%3 - 1, 2);
+
+    if(!enemy->hp[m]){
         link->enemies_to_kill--;
         survivor_points++;
 
-        Nokia5110_ClearBitmap(enemy->x,enemy->y,enemy->last_sprite);
-        Level_WarMapClear(enemy->last_sprite,enemy->x,enemy->y,ENEMY);
+        Collision_Remove(COLLISION_ENEMY+m);
+        Effect_Play(enemy->x[m], enemy->y[m], archetype->sprite[step][ATTACKED2], archetype->sprite[step][ATTACKED1],
+                    2, DEFEAT_TICKS, 0, 0);
+        Enemy_Remove(enemy, m);
 
-        uint8_t i;
-        for(i=0;i<2;i++){
-            enemy->last_sprite = enemy->sprite[enemy->step][ATTACKED2-i];
-            Nokia5110_PrintBMP(enemy->x,enemy->y,enemy->last_sprite,0);
-            Nokia5110_DisplayBuffer();
-            SysCtlDelay(SysCtlClockGet()/10);
-        }
-        Nokia5110_ClearBitmap(enemy->x,enemy->y,enemy->last_sprite);
-        Nokia5110_DisplayBuffer();
-        enemy->last_sprite = 0;
+        // it may have been in the way of the followers
+        Level_Obstacles(level.enemy_queue);
+    }else{
+        Effect_Play(x, y, spark, 0, 1, SPARK_TICKS, 0, 0);
     }
 }
 
 // Link loses life and change his position
-void Link_IsAttacked(Link_t *link, Enemy_t *enemy){
+void Link_IsAttacked(Link_t *link, Enemies_t *enemy, uint8_t m){
 
-        uint8_t forward = 3*enemy->status;
+        const Archetype_t *archetype = &enemy_archetype[enemy->type[m]];
+        uint8_t status = enemy->flags[m] & ENEMY_STATUS;
+        uint8_t forward = 3*status;
+        bool baked = enemy->flags[m] & ENEMY_BAKED;     // a baked enemy doesn't move
+
+        // the sword is put away before Link is pushed back
+        if(link->attack) Link_Sheathe(link);
 
         Nokia5110_ClearBitmap(link->x,link->y,link->last_sprite);
-        Nokia5110_ClearBitmap(enemy->x,enemy->y,enemy->last_sprite);
-        Level_WarMapClear(link->last_sprite, link->x, link->y, LINK);
-        Level_WarMapClear(enemy->last_sprite, enemy->x, enemy->y, ENEMY);
+        Collision_Remove(COLLISION_LINK);
+        if(!baked){
+            Nokia5110_ClearBitmap(enemy->x[m],enemy->y[m],Enemy_Sprite(enemy, m));
+            Collision_Remove(COLLISION_ENEMY+m);
+        }
 
         // change Link's position based on his last direction
 
-        if(enemy->status==DUMB){
+        if(status==DUMB){
             switch(link->direction){
                 case UP:
                     link->y +=2;
@@ -1162,8 +1951,8 @@ void Link_IsAttacked(Link_t *link, Enemy_t *enemy){
                     if(link->y < MAX_Y - 7) link->y+=6;
                     else link->y = MAX_Y -1;
 
-                    if(enemy->y >= enemy->size_y + forward+1) enemy->y-=forward;
-                    else enemy->y = enemy->size_y+1;
+                    if(enemy->y[m] >= archetype->h + forward+1) enemy->y[m]-=forward;
+                    else enemy->y[m] = archetype->h+1;
 
                     break;
 
@@ -1171,8 +1960,8 @@ void Link_IsAttacked(Link_t *link, Enemy_t *enemy){
                     if(link->x >= 7) link->x-=6;
                     else link->x = 0;
 
-                    if(enemy->x < MAX_X - enemy->size_x - forward-1) enemy->x+=forward;
-                    else enemy->x = MAX_X -1;
+                    if(enemy->x[m] < MAX_X - archetype->w - forward-1) enemy->x[m]+=forward;
+                    else enemy->x[m] = MAX_X -1;
 
                     break;
 
@@ -1180,8 +1969,8 @@ void Link_IsAttacked(Link_t *link, Enemy_t *enemy){
                     if(link->y >= link->size_y + 7) link->y-=6;
                     else link->y = link->size_y+1;
 
-                    if(enemy->y < MAX_Y - forward-1) enemy->y+=forward;
-                    else enemy->y = MAX_Y -1;
+                    if(enemy->y[m] < MAX_Y - forward-1) enemy->y[m]+=forward;
+                    else enemy->y[m] = MAX_Y -1;
 
                     break;
 
@@ -1189,184 +1978,346 @@ void Link_IsAttacked(Link_t *link, Enemy_t *enemy){
                     if(link->x < MAX_X - link->size_x - 7) link->x+=6;
                     else link->x = MAX_X -1;
 
-                    if(enemy->x >= forward+1) enemy->x-=forward;
-                    else enemy->x = 0;
+                    if(enemy->x[m] >= forward+1) enemy->x[m]-=forward;
+                    else enemy->x[m] = 0;
 
                     break;
             }
         }
 
         Nokia5110_PrintBMP(link->x,link->y,link->last_sprite,0);
-        Nokia5110_PrintBMP(enemy->x,enemy->y,enemy->last_sprite,0);
+        if(!baked) Nokia5110_PrintBMP(enemy->x[m],enemy->y[m],Enemy_Sprite(enemy, m),0);
+        level_dirty = 1;
 
-        Nokia5110_DisplayBuffer();
-        SysCtlDelay(SysCtlClockGet() / 20);
+        // a spark on Link instead of stopping the game
+        Effect_Play(link->x + link->size_x/2 - 2, link->y - link->size_y/2 + 2, spark, 0, 1, SPARK_TICKS, 0, 0);
 
-        Link_LifeLoss(link,enemy->damage);
-        Level_WarMapUpdate(link, enemy, link->last_sprite, link->x, link->y, LINK);
-        Level_WarMapUpdate(link, enemy, enemy->last_sprite, enemy->x, enemy->y, ENEMY);
+        Link_LifeLoss(link,archetype->damage);
+        Level_Collide(COLLISION_LINK, link->last_sprite, link->x, link->y);
+        if(!baked) Level_Collide(COLLISION_ENEMY+m, Enemy_Sprite(enemy, m), enemy->x[m], enemy->y[m]);
 }
 
 // Link loses the same amount of life that the enemy's damage value
 void Link_LifeLoss(Link_t *link, uint8_t damage){
     link->life -= damage;
     Lifebar_Update(link->life);
-    if(link->life<=0) Link_IsDead(link);
 }
 
 // Game Over
-void Link_IsDead(Link_t *link){
-    Nokia5110_ClearBitmap(link->x,link->y,link->last_sprite);
-    Nokia5110_PrintBMP(link->x,link->y,link_dead,0);
-    Nokia5110_DisplayBuffer();
-    SysCtlDelay(SysCtlClockGet()/5);
-    Nokia5110_ClearBuffer();
-    Nokia5110_Clear();
-    SysCtlDelay(SysCtlClockGet()/5);
-    Nokia5110_PrintBMP(4,26,GameOver3,0);
-    Nokia5110_DisplayBuffer();
-    SysCtlDelay(SysCtlClockGet()/15);
-    Nokia5110_PrintBMP(4,26,GameOver2,0);
-    Nokia5110_DisplayBuffer();
-    SysCtlDelay(SysCtlClockGet()/15);
-    Nokia5110_PrintBMP(4,26,GameOver,0);
-    Nokia5110_DisplayBuffer();
+static uint8_t gameover_frame;  // animation frame counter
 
-    Nokia5110_PrintBMP(35,42,link_dead,0);
-    Nokia5110_DisplayBuffer();
-    while(GetSwitch(GetButton())==BUTTON_NOT_PRESSED){}
+void GameOver_Enter(uint8_t from){
+    gameover_frame = 0;
+    Game_Wait(0);
+}
+
+uint8_t GameOver_Update(){
+    Link_t *link = &(level.link);
+
+    switch(gameover_frame){
+        case 0:
+            Nokia5110_ClearBitmap(link->x,link->y,link->last_sprite);
+            Nokia5110_PrintBMP(link->x,link->y,link_dead,0);
+            Nokia5110_DisplayBuffer();
+            Game_Wait(600);
+            break;
+        case 1:
+            Nokia5110_ClearBuffer();
+            Nokia5110_Clear();
+            Game_Wait(600);
+            break;
+        case 2:
+            Nokia5110_PrintBMP(4,26,GameOver3,0);
+            Nokia5110_DisplayBuffer();
+            Game_Wait(200);
+            break;
+        case 3:
+            Nokia5110_PrintBMP(4,26,GameOver2,0);
+            Nokia5110_DisplayBuffer();
+            Game_Wait(200);
+            break;
+        case 4:
+            Nokia5110_PrintBMP(4,26,GameOver,0);
+            Nokia5110_DisplayBuffer();
+
+            Nokia5110_PrintBMP(35,42,link_dead,0);
+            Nokia5110_DisplayBuffer();
+            break;
+        default:
+            // waits for a key
+            if(GetSwitch(GetButton())!=BUTTON_NOT_PRESSED) return STATE_TITLE;
+            return STATE_GAMEOVER;
+    }
+    gameover_frame++;
+    return STATE_GAMEOVER;
+}
 
-    Level_WarMapStart(warmap);
+void GameOver_Exit(uint8_t to){
+    Collision_Clear();
 
     Nokia5110_Clear();
     Nokia5110_ClearBuffer();
+
+    if(mode) SurvivorMode_Score();
 }
 
 // =====================================================
 // ### ENEMY ACTIONS ###
 
-// Summon up a new enemy on a fixed place at the display
-
-Enemy_t Enemy_New(uint8_t index, uint8_t x, uint8_t y, uint8_t life, uint8_t damage, uint8_t status){
-    Enemy_t monster;
-    monster.x = x;
-    monster.y = y;
-    monster.sprite[0] = enemy_array[index][0];
-    monster.sprite[1] = enemy_array[index][1];
-    monster.last_sprite = monster.sprite[0][0];
-    monster.size_x = Nokia5110_getWidth(monster.last_sprite);
-    monster.size_y = Nokia5110_getHeight(monster.last_sprite);
-    monster.life = life;
-    monster.damage = damage;
-
-    monster.status = status;
-    monster.step = 0;
-    monster.direction = DOWN;
-
-    Nokia5110_PrintBMP(monster.x, monster.y,monster.last_sprite,0);
-    Nokia5110_DisplayBuffer();
+// Summon up a new enemy in a free slot, on a fixed place at the display
+// Returns the slot, ENEMY_NONE if the level is full
+uint8_t Enemy_New(Enemies_t *enemy, uint8_t type, uint8_t x, uint8_t y){
+    const Archetype_t *archetype = &enemy_archetype[type];
+    uint8_t m;  // monster index
 
-    return monster;
-}
+    m = Pool_Take(enemy->pool);
+    if(m==POOL_NONE) return ENEMY_NONE;
 
-// Change the enemy position and sprite
-// Some enemies will follow Link, some have pattern moves
-void Enemy_Move(Link_t *link, Enemy_t *enemy){
-    uint8_t m; // monster index
+    enemy->x[m] = x;
+    enemy->y[m] = y;
+    enemy->type[m] = type;
+    enemy->anim[m] = UP;
+    enemy->hp[m] = archetype->life;
+    enemy->flags[m] = archetype->behavior | ENEMY_ALIVE;
+    enemy->behavior[m] = (Behavior_t){0};
+    Animation_Start(&enemy->animation[m], archetype->walk);
 
-    for(m=0;m<6;m++){
+    // drawn, the screen is shown once all of them are
+    Nokia5110_PrintBMP(x, y, Enemy_Sprite(enemy, m), 0);
 
-        Nokia5110_PrintBMP(enemy[m].x,enemy[m].y,enemy[m].last_sprite,0);
-        Nokia5110_DisplayBuffer();
+    return m;
+}
 
-        if(enemy[m].status==FOLLOWER){
-            Nokia5110_ClearBitmap(enemy[m].x,enemy[m].y,enemy[m].last_sprite);
-            Level_WarMapClear(enemy[m].last_sprite, enemy[m].x, enemy[m].y, ENEMY);
+// Empties slot m, the others keep their order
+void Enemy_Remove(Enemies_t *enemy, uint8_t m){
+    enemy->flags[m] = 0;
+    Pool_Give(enemy->pool, m);
+}
 
-            int sign;
+// Sprite shown by enemy m, NULL if the slot is empty
+// The frame of the sheet is where it looks, the step comes from its animation
+const unsigned char *Enemy_Sprite(Enemies_t *enemy, uint8_t m){
+    if(!(enemy->flags[m] & ENEMY_ALIVE)) return 0;
+    return enemy_archetype[enemy->type[m]].sprite[enemy->animation[m].pose][enemy->anim[m]];
+}
 
-            if(link->x < enemy[m].x) enemy[m].direction = LEFT;
-            if(link->x > enemy[m].x) enemy[m].direction = RIGHT;
+// Shows enemy m with the given frame of its sprite sheet, in the step of its animation
+void Enemy_Pose(Enemies_t *enemy, uint8_t m, uint8_t frame){
+    enemy->anim[m] = frame;
+}
 
-            sign = (link->x - enemy[m].x > 0) - (link->x - enemy[m].x < 0);
-            enemy[m].x += sign;
+// Change the enemy position and sprite
+// The behavior program of each enemy says how it moves (behavior.h)
+// Each enemy moves every period level ticks of its archetype, with the enemy
+// slot as phase, so the moves are spread over the ticks and the cost of a
+// tick doesn't grow with the enemies of the same type. Enemies that don't
+// move in a tick are only drawn again if Link or a moving enemy may have
+// erased them, and the baked ones never: the erase puts them back.
+void Enemy_Move(Link_t *link, Enemies_t *enemy){
+    const Archetype_t *archetype;   // stats of the monster
+    const Archetype_t *other;       // stats of a monster that moved
+    uint8_t j, k;       // indexes of moved
+    uint8_t m;          // monster index
+    uint8_t action;     // what the program of the monster does
+    uint8_t direction;  // where the monster looks
+    int8_t dx, dy;      // step of the monster
+    uint8_t moved[ENEMIES]; // monsters that moved in this tick
+    uint8_t n_moved = 0;
+
+    // the followers' way to Link, a part of it each tick
+    Flow_Target(link->x + link->size_x/2, link->y - link->size_y/2);
+    Flow_Step(FLOW_BUDGET);
+
+    for(m=enemy->pool->first;m!=POOL_NONE;m=enemy->next[m]){
+        archetype = &enemy_archetype[enemy->type[m]];
+        if(!archetype->period || (enemy_tick + m) % archetype->period) continue;
+
+        enemy_updates[enemy->flags[m] & ENEMY_STATUS]++;
+
+        dx = dy = 0;
+        direction = enemy->anim[m];
+        action = Behavior_Run(archetype->program, &enemy->behavior[m], enemy->hp[m], &direction, &dx, &dy);
+
+        // it walks while it moves, Level_Animate plays the clip
+        if(action==BEHAVIOR_WAIT || action==BEHAVIOR_FACE || action==BEHAVIOR_SHOOT){
+            Animation_Play(&enemy->animation[m], archetype->idle);
+        }else{
+            Animation_Play(&enemy->animation[m], archetype->walk);
+        }
 
-            sign = (link->y - enemy[m].y > 0) - (link->y - enemy[m].y < 0);
-            // this way big enemies don't go out of the screen
-            if(enemy[m].y>=enemy[m].size_y) enemy[m].y += sign;
+        if(action==BEHAVIOR_WAIT) continue;
+        if(action==BEHAVIOR_SHOOT){
+            Enemy_Shoot(link, enemy, m);
+            continue;
+        }
+        moved[n_moved++] = m;
 
-            // updates enemy last sprite
-            enemy[m].last_sprite = enemy[m].sprite[enemy[m].step][enemy[m].direction];
-            enemy[m].step = !(enemy[m].step); // alternate enemy step for sprite animation
+        if(action==BEHAVIOR_CHASE){
+            Enemy_Follow(link, enemy, m);
+            continue;
+        }
+        if(action==BEHAVIOR_MOVE){
+            dx = enemy_dx[direction] * archetype->speed;
+            dy = enemy_dy[direction] * archetype->speed;
+        }
+        Enemy_Walk(enemy, m, direction, dx, dy);
+    }
 
-            Nokia5110_PrintBMP(enemy[m].x,enemy[m].y,enemy[m].last_sprite,0);
-            Nokia5110_DisplayBuffer();
+    // moved is in the pool order, so the ones that didn't move are between
+    for(m=enemy->pool->first, j=0;m!=POOL_NONE;m=enemy->next[m]){
+        if(j<n_moved && moved[j]==m){
+            j++;
+            continue;
+        }
+        if(enemy->flags[m] & ENEMY_BAKED) continue;
+        archetype = &enemy_archetype[enemy->type[m]];
+
+        if(Collision_Overlaps(enemy->x[m], enemy->y[m], archetype->w, archetype->h,
+                              link->x, link->y, link->size_x, link->size_y)){
+            Nokia5110_PrintBMP(enemy->x[m],enemy->y[m],Enemy_Sprite(enemy, m),0);
+            level_dirty = 1;
+            continue;
+        }
 
-            Level_WarMapUpdate(link, enemy, enemy[m].last_sprite, enemy[m].x, enemy[m].y, ENEMY);
+        for(k=0;k<n_moved;k++){
+            other = &enemy_archetype[enemy->type[moved[k]]];
+            if(Collision_Overlaps(enemy->x[m], enemy->y[m], archetype->w, archetype->h,
+                                  enemy->x[moved[k]], enemy->y[moved[k]], other->w, other->h)){
+                Nokia5110_PrintBMP(enemy->x[m],enemy->y[m],Enemy_Sprite(enemy, m),0);
+                break;
+            }
         }
+    }
 
+    enemy_tick++;
+    if(n_moved) level_dirty = 1;
+}
 
-        if(enemy[m].status==ACTIVE){
-            Nokia5110_ClearBitmap(enemy[m].x,enemy[m].y,enemy[m].last_sprite);
-            Level_WarMapClear(enemy[m].last_sprite, enemy[m].x, enemy[m].y, ENEMY);
-            srand(SysTickValueGet());
+// Moves an enemy towards Link
+// It follows the flow field around the static enemies, speed pixels a move.
+// Close to Link, or while there is no field yet, it goes straight to him
+// without going past him. It doesn't step onto another enemy.
+void Enemy_Follow(Link_t *link, Enemies_t *enemy, uint8_t m){
+    const Archetype_t *archetype = &enemy_archetype[enemy->type[m]];
+    int speed = archetype->speed;
+    uint8_t direction = enemy->anim[m];
+    int8_t dx, dy;      // step on each axis
+    int x, y;           // next position
+
+    Nokia5110_ClearBitmap(enemy->x[m],enemy->y[m],Enemy_Sprite(enemy, m));
+    Collision_Remove(COLLISION_ENEMY+m);
+
+    if(Flow_Direction(enemy->x[m] + archetype->w/2, enemy->y[m] - archetype->h/2, &dx, &dy)){
+        x = enemy->x[m] + dx * speed;
+        y = enemy->y[m] + dy * speed;
+    }else{
+        x = link->x - enemy->x[m];
+        if(x > speed) x = speed;
+        if(x < -speed) x = -speed;
+        x += enemy->x[m];
+
+        y = link->y - enemy->y[m];
+        if(y > speed) y = speed;
+        if(y < -speed) y = -speed;
+        y += enemy->y[m];
+    }
 
-            enemy[m].direction = rand()%5;
+    // inside the screen
+    if(x < 0) x = 0;
+    if(x > MAX_X - archetype->w) x = MAX_X - archetype->w;
+    if(y < archetype->h - 1) y = archetype->h - 1;
+    if(y > MAX_Y - 1) y = MAX_Y - 1;
+
+    // one axis at a time if the whole step runs into another enemy
+    if(Enemy_Crowded(enemy, m, x, y)){
+        if(!Enemy_Crowded(enemy, m, x, enemy->y[m])) y = enemy->y[m];
+        else if(!Enemy_Crowded(enemy, m, enemy->x[m], y)) x = enemy->x[m];
+        else{
+            x = enemy->x[m];
+            y = enemy->y[m];
+        }
+    }
 
-            // Change enemy direction and move it randomly
-            switch(enemy[m].direction){
-                case UP:
-                    enemy[m].direction = UP;
-                    if(enemy[m].y > enemy[m].size_y + 2){
-                        // change enemy position if it is not in the screen border
-                        enemy[m].y-=2;
-                    }else{
-                        // if enemy go out of the screen, change it's position to the border
-                        enemy[m].y = enemy[m].size_y;
-                    }
-                    break;
+    if(x < enemy->x[m]) direction = LEFT;
+    if(x > enemy->x[m]) direction = RIGHT;
+    enemy->x[m] = x;
+    enemy->y[m] = y;
 
-                case RIGHT:
-                    enemy[m].direction = RIGHT;
-                    if(enemy[m].x < MAX_X - enemy[m].size_x - 2){
-                        enemy[m].x+=2;
-                    }else{
-                        enemy[m].x = MAX_X - enemy[m].size_x - 1;
-                    }
-                    break;
+    Enemy_Pose(enemy, m, direction);
+    Nokia5110_PrintBMP(enemy->x[m],enemy->y[m],Enemy_Sprite(enemy, m),0);
 
-                case DOWN:
-                    enemy[m].direction = DOWN;
-                    if(enemy[m].y < MAX_Y - 2){
-                        enemy[m].y+=2;
-                    }else{
-                        enemy[m].y = MAX_Y - 1;
-                    }
-                    break;
+    Level_Collide(COLLISION_ENEMY+m, Enemy_Sprite(enemy, m), enemy->x[m], enemy->y[m]);
+}
 
-                case LEFT:
-                    enemy[m].direction = LEFT;
-                    if(enemy[m].x >= 2){
-                        enemy[m].x-=2;
-                    }else{
-                        enemy[m].x = 0;
-                    }
-                    break;
+// Enemy m fires a feather at Link from its middle
+// The feather goes as fast on the longest axis whatever the direction
+void Enemy_Shoot(Link_t *link, Enemies_t *enemy, uint8_t m){
+    const Archetype_t *archetype = &enemy_archetype[enemy->type[m]];
+    uint8_t w = Nokia5110_getWidth(feather);
+    uint8_t h = Nokia5110_getHeight(feather);
+    uint8_t x = enemy->x[m] + archetype->w/2 - w/2;
+    uint8_t y = enemy->y[m] - archetype->h/2 + h/2;
+    int16_t dx = (link->x + link->size_x/2) - (x + w/2);   // from the feather to Link
+    int16_t dy = (link->y - link->size_y/2) - (y - h/2);
+    int16_t far = abs(dx) > abs(dy) ? abs(dx) : abs(dy);
+
+    if(!far) return;
+    if(Projectile_Fire(PROJECTILE_ENEMY, feather, x, y,
+                       FEATHER_SPEED*dx/far, FEATHER_SPEED*dy/far, FEATHER_LIFE)!=PROJECTILE_NONE){
+        Nokia5110_PrintBMP(x, y, feather, 0);
+    }
+}
 
-                default:
-                    enemy[m].direction = UP;
-                    break;
-            }
-            // updates enemy last sprite
-            enemy[m].last_sprite = enemy[m].sprite[enemy[m].step][enemy[m].direction];
-            enemy[m].step = !(enemy[m].step); // alternate enemy step for sprite animation
+// Returns 1 if enemy m at (x, y) would overlap an enemy it isn't overlapping yet
+bool Enemy_Crowded(Enemies_t *enemy, uint8_t m, uint8_t x, uint8_t y){
+    const Archetype_t *archetype = &enemy_archetype[enemy->type[m]];
+    const Archetype_t *other;
+    uint8_t k;  // other monster index
+
+    for(k=enemy->pool->first;k!=POOL_NONE;k=enemy->next[k]){
+        if(k==m) continue;
+        other = &enemy_archetype[enemy->type[k]];
+        if(Collision_Overlaps(x, y, archetype->w, archetype->h,
+                              enemy->x[k], enemy->y[k], other->w, other->h) &&
+           !Collision_Overlaps(enemy->x[m], enemy->y[m], archetype->w, archetype->h,
+                               enemy->x[k], enemy->y[k], other->w, other->h)){
+            return 1;
+        }
+    }
+    return 0;
+}
 
-            Nokia5110_PrintBMP(enemy[m].x,enemy[m].y,enemy[m].last_sprite,0);
-            Nokia5110_DisplayBuffer();
+// Moves an enemy by dx, dy inside the screen, looking to direction
+// It looks the way it goes, or keeps the direction if it doesn't move
+void Enemy_Walk(Enemies_t *enemy, uint8_t m, uint8_t direction, int8_t dx, int8_t dy){
+    const Archetype_t *archetype = &enemy_archetype[enemy->type[m]];
+    int x, y;           // next position
 
-            Level_WarMapUpdate(link, enemy, enemy[m].last_sprite, enemy[m].x, enemy[m].y, ENEMY);
+    Nokia5110_ClearBitmap(enemy->x[m],enemy->y[m],Enemy_Sprite(enemy, m));
+    Collision_Remove(COLLISION_ENEMY+m);
 
-        }
+    x = enemy->x[m] + dx;
+    y = enemy->y[m] + dy;
 
+    // only the axes it moves on are kept inside the screen
+    if(dx){
+        if(x < 0) x = 0;
+        if(x > MAX_X - archetype->w - 1) x = MAX_X - archetype->w - 1;
     }
+    if(dy){
+        if(y < archetype->h) y = archetype->h;
+        if(y > MAX_Y - 1) y = MAX_Y - 1;
+    }
+    enemy->x[m] = x;
+    enemy->y[m] = y;
+
+    if(dx > 0) direction = RIGHT;
+    else if(dx < 0) direction = LEFT;
+    else if(dy < 0) direction = UP;
+    else if(dy > 0) direction = DOWN;
+
+    Enemy_Pose(enemy, m, direction);
+    Nokia5110_PrintBMP(enemy->x[m],enemy->y[m],Enemy_Sprite(enemy, m),0);
+
+    Level_Collide(COLLISION_ENEMY+m, Enemy_Sprite(enemy, m), enemy->x[m], enemy->y[m]);
 }
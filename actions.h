@@ -12,54 +12,158 @@ void Setup();
 // Get the pressed switch information
 uint8_t GetSwitch(uint8_t sw);
 
+// Wait until any switch is pressed, with the clock scaled down
+void WaitSwitch();
+
+// =====================================================
+// ### SCREENS ###
+// Game state handlers, see game.h
+// Enter gets the previous state, exit the next one
+// Update does one step and returns the next state
+
 // Generate the title screen animation
-void TitleScreen();
+void TitleScreen_Enter(uint8_t from);
+uint8_t TitleScreen_Update();
+void TitleScreen_Exit(uint8_t to);
 
 // Generate the selection screen
-void SelectionScreen();
+void SelectionScreen_Enter(uint8_t from);
+uint8_t SelectionScreen_Update();
+void SelectionScreen_Exit(uint8_t to);
 
 // Generate the instruction screen
-void InstructionScreen();
+void InstructionScreen_Enter(uint8_t from);
+uint8_t InstructionScreen_Update();
+void InstructionScreen_Exit(uint8_t to);
 
 // Generate the story screen
-void StoryScreen();
+void StoryScreen_Enter(uint8_t from);
+uint8_t StoryScreen_Update();
+void StoryScreen_Exit(uint8_t to);
 
 // Display the top 3 high scores
-void HighScoreScreen();
+void HighScoreScreen_Enter(uint8_t from);
+uint8_t HighScoreScreen_Update();
+void HighScoreScreen_Exit(uint8_t to);
+
+// =====================================================
+// ### STORY MODE ###
+
+// Start a new game, then go through levels and cutscenes
+void NewGame_Enter(uint8_t from);
+uint8_t NewGame_Update();
+void NewGame_Exit(uint8_t to);
 
-// Start a new game
-void NewGame();
+// Plays one frame of a cutscene
+// returns how long the frame stays on the screen, 0 when the cutscene is over
+uint16_t Cutscene_Play(uint8_t scene, uint8_t frame);
+
+// =====================================================
+// ### HUD ###
 
 // Update lifebar heart sprites when Link's life change
 void Lifebar_Update(uint8_t life);
 
-// Pauses the game. Return 1 if quit. 0 if not
-bool Pause();
+// Put the number of killed enemies on screen
+void DisplayScore();
+
+// Pauses the game and asks for continue or quit
+void Pause_Enter(uint8_t from);
+uint8_t Pause_Update();
+void Pause_Exit(uint8_t to);
+
+// =====================================================
+// ### SURVIVOR MODE ###
 
 // Link must kill as many monsters as he can
-void SurvivorMode();
+void SurvivorMode_Enter(uint8_t from);
+uint8_t SurvivorMode_Update();
+void SurvivorMode_Exit(uint8_t to);
 
-// Put the number of killed enemies on screen
-void DisplayScore();
+// Puts the survivor mode score in the high scores
+void SurvivorMode_Score();
 
 // =====================================================
 // ### LEVEL INTERACTIONS ###
 
-// Set a new level.
-// returns 1 when finished, 0 when GameOver
-bool Level_New(Enemy_t *queue, uint8_t n_monsters);
+// Starts setting a new level, or a cutscene, with no monster yet
+// The level arena is given back and the monsters are taken from it again
+Enemies_t *Level_New(void);
+
+// Sets the monsters of the next level
+void Level_Set(Enemies_t *queue, uint8_t n_monsters);
+
+// Sets the next level from its record
+// The monsters that come with it are drawn but not shown yet
+void Level_Load(const Level_Def_t *def);
+
+// Takes the monsters of the level record that come now, running says if the
+// level is running already
+void Level_Spawn(Enemies_t *enemy, bool running);
+
+// Marks the cells of the spawn planner taken by the lifebar, the monsters
+// and Link, where he stands if the level is running, else where he starts
+void Level_Occupancy(Enemies_t *enemy, bool running);
+
+// Monsters of the level that come in late, when their delay is over
+void Level_Arrivals(Enemies_t *enemy);
+
+// Puts an enemy in the collision boxes, and in the background if it never moves
+void Level_Place(Enemies_t *enemy, uint8_t m);
+
+// Set a new level, then run it one tick at each update
+// Update returns STATE_GAMEOVER when Link dies, the game mode state when finished
+void Level_Enter(uint8_t from);
+uint8_t Level_Update();
+void Level_Exit(uint8_t to);
 
-// Creates the warmap for the level
-void Level_WarMapStart(uint8_t warmap[48][84]);
+// Shows the buffer on the screen, if something was drawn in it since the last time
+void Level_Present(void);
 
-// Updates the warmap when Link or an enemy moves
-void Level_WarMapUpdate(Link_t *link, Enemy_t *enemy, const unsigned char *sprite, uint8_t x, uint8_t y, uint8_t value);
+// Puts Link or an enemy in the collision boxes and records what it hits
+// id is one of the collision ids (see collision.h)
+void Level_Collide(uint8_t id, const unsigned char *sprite, uint8_t x, uint8_t y);
 
-// Clears the warmap
-void Level_WarMapClear(const unsigned char *sprite, uint8_t x, uint8_t y, uint8_t value);
+// Records what the box of id touches
+void Level_Touch(uint8_t id);
 
-// Returns which monster is being attacked or attacking
-uint8_t Level_WarMapCheckEnemy(Enemy_t *enemy, uint8_t status);
+// Handles the hits recorded since the last call, once everything has moved
+void Level_Resolve(Link_t *link, Enemies_t *enemy);
+
+// Static enemies are obstacles for the followers
+void Level_Obstacles(Enemies_t *enemy);
+
+// Steps the animations of Link and of the enemies a tick
+void Level_Animate(Link_t *link, Enemies_t *enemy);
+
+// A new swing of the sword, every enemy can be hit again
+void Level_Unstrike(Enemies_t *enemy);
+
+// Something w x h at (x, y) was erased, the enemies it was over are marked
+// to be drawn again by Level_Redraw
+// Returns 1 if it was over Link
+bool Level_Under(Link_t *link, Enemies_t *enemy, uint8_t x, uint8_t y, uint8_t w, uint8_t h);
+
+// Draws again the marked enemies, and Link if link_erased
+void Level_Redraw(Link_t *link, Enemies_t *enemy, bool link_erased);
+
+// Takes a baked enemy out of the background and off the screen
+void Level_Unbake(Enemies_t *enemy, uint8_t m);
+
+// Cucco revenge, the swarm comes once the cuccos are angry enough
+void Level_Swarm(Link_t *link, Enemies_t *enemy);
+
+// The swarm flies away and the cuccos forget
+void Level_Calm(void);
+
+// Moves, hits with and draws the sword beams and feathers
+void Level_Projectiles(Link_t *link, Enemies_t *enemy);
+
+// Every projectile falls
+void Level_Ceasefire(void);
+
+// Plays the defeats, sparks and lost feathers a tick
+void Level_Effects(Link_t *link, Enemies_t *enemy);
 
 // =====================================================
 // ### LINK ACTIONS ####
@@ -68,30 +172,67 @@ uint8_t Level_WarMapCheckEnemy(Enemy_t *enemy, uint8_t status);
 Link_t Link_New();
 
 // Change the hero position and sprite
-void Link_Move(Link_t *link, Enemy_t *enemy);
+// returns the switch that was handled
+uint8_t Link_Move(Link_t *link, Enemies_t *enemy);
+
+// Shows the next frame of Link's attack and moves the sword hitbox
+void Link_Swing(Link_t *link);
+
+// Puts the sword away and shows Link walking again
+void Link_Sheathe(Link_t *link);
+
+// With full life, a swing ends shooting a beam
+void Link_Beam(Link_t *link);
+
+// Sword frame drawn at an attack frame, SWORD_FRAMES if none fits in the screen
+uint8_t Link_SwordFrame(Link_t *link, uint8_t frame);
 
 // Set the hero to attack mode
-void Link_Attack(Link_t *link, Enemy_t *enemy);
+void Link_Attack(Link_t *link, Enemies_t *enemy, uint8_t m);
 
 // Link loses the same amount of life that the enemy's damage value
 void Link_LifeLoss(Link_t *link, uint8_t damage);
 
 // Link change his position when attacked
-void Link_IsAttacked(Link_t *link, Enemy_t *enemy);
+void Link_IsAttacked(Link_t *link, Enemies_t *enemy, uint8_t m);
 
 // Game Over
-void Link_IsDead();
+void GameOver_Enter(uint8_t from);
+uint8_t GameOver_Update();
+void GameOver_Exit(uint8_t to);
 
 
 // =====================================================
 // ### ENEMY ACTIONS ###
 
-// Summon up a new enemy on a fixed place at the display
-// IT WORKS JUST FOR GRASS BY NOW
-Enemy_t Enemy_New(uint8_t index, uint8_t x, uint8_t y, uint8_t life, uint8_t damage, uint8_t status);
+// Summon up a new enemy of the given code in a free slot, on a fixed place at the display
+// Its sprites and stats come from the archetype of the code
+// Returns the slot, ENEMY_NONE if the level is full
+uint8_t Enemy_New(Enemies_t *enemy, uint8_t type, uint8_t x, uint8_t y);
+
+// Empties slot m, the others keep their order
+void Enemy_Remove(Enemies_t *enemy, uint8_t m);
+
+// Sprite shown by enemy m, NULL if the slot is empty
+const unsigned char *Enemy_Sprite(Enemies_t *enemy, uint8_t m);
+
+// Shows enemy m with the given frame of its sprite sheet
+void Enemy_Pose(Enemies_t *enemy, uint8_t m, uint8_t frame);
 
 // Change the enemy position and sprite
-// Some enemies will follow Link, some have pattern moves
-void Enemy_Move(Link_t *link, Enemy_t *enemy);
+// The behavior program of each enemy says how it moves
+void Enemy_Move(Link_t *link, Enemies_t *enemy);
+
+// Moves an enemy towards Link
+void Enemy_Follow(Link_t *link, Enemies_t *enemy, uint8_t m);
+
+// Enemy m fires a feather at Link
+void Enemy_Shoot(Link_t *link, Enemies_t *enemy, uint8_t m);
+
+// Returns 1 if enemy m at (x, y) would overlap an enemy it isn't overlapping yet
+bool Enemy_Crowded(Enemies_t *enemy, uint8_t m, uint8_t x, uint8_t y);
+
+// Moves an enemy by dx, dy inside the screen, looking to direction
+void Enemy_Walk(Enemies_t *enemy, uint8_t m, uint8_t direction, int8_t dx, int8_t dy);
 
 #endif
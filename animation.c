@@ -0,0 +1,57 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "animation.h"
+#include "ramfunc.h"
+
+// =====================================================
+// A clip, frames poses each shown for its ticks
+// 0 ticks holds the frame for ever
+typedef struct{
+    uint8_t frames;
+    uint8_t pose[CLIP_FRAMES];
+    uint8_t ticks[CLIP_FRAMES];
+} Clip_t;
+
+static const Clip_t clip_table[CLIPS] = {
+    //  frames  poses   ticks
+    {1,     {0, 0}, {0, 0}},        // CLIP_STILL
+    {2,     {0, 1}, {1, 1}},        // CLIP_TROT
+    {2,     {0, 1}, {2, 2}},        // CLIP_WALK
+    {2,     {0, 1}, {3, 3}},        // CLIP_STROLL
+    {2,     {0, 1}, {12, 3}},       // CLIP_IDLE
+};
+
+// =====================================================
+// ### CLIPS ###
+
+// Starts clip from its first frame, the pose changes right away
+void Animation_Start(Animation_t *animation, uint8_t clip){
+    animation->clip = clip;
+    animation->frame = 0;
+    animation->pose = clip_table[clip].pose[0];
+    animation->wait = clip_table[clip].ticks[0];
+}
+
+// Goes on with clip, from its first frame at the next step if it wasn't
+// playing it already. The pose shown stays until then.
+void Animation_Play(Animation_t *animation, uint8_t clip){
+    if(animation->clip==clip) return;
+    animation->clip = clip;
+    animation->frame = clip_table[clip].frames - 1;
+    animation->wait = 1;
+}
+
+// Moves the animation a tick
+// Returns 1 if the pose changed, and the entity must be drawn again
+RAMFUNC bool Animation_Step(Animation_t *animation){
+    const Clip_t *clip = &clip_table[animation->clip];
+    uint8_t pose = animation->pose;
+
+    if(!animation->wait || --animation->wait) return 0;
+
+    if(++animation->frame==clip->frames) animation->frame = 0;
+    animation->wait = clip->ticks[animation->frame];
+    animation->pose = clip->pose[animation->frame];
+    return animation->pose!=pose;
+}
@@ -0,0 +1,39 @@
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "definitions.h"
+
+// =====================================================
+// Animation clips
+// A clip is a loop of poses, the steps of a sprite sheet, each shown for a
+// number of level ticks. Link and every enemy keep their clip, frame and
+// ticks left in an Animation_t, and the level steps all of them once a
+// tick, apart from their moves: an entity standing still goes on with its
+// clip, and a step costs one table entry whatever the clip.
+// The clips are in clip_table, animation.c.
+#define CLIP_STILL          0   // the first step, for ever
+#define CLIP_TROT           1   // a step each tick, Link walking and the cutscenes
+#define CLIP_WALK           2   // a step every 2 ticks, the followers
+#define CLIP_STROLL         3   // a step every 3 ticks, the cuccos
+#define CLIP_IDLE           4   // stands, shifting now and then
+#define CLIPS               5
+#define CLIP_FRAMES         2   // frames of a clip at most
+
+// =====================================================
+// ### CLIPS ###
+
+// Starts clip from its first frame, the pose changes right away
+void Animation_Start(Animation_t *animation, uint8_t clip);
+
+// Goes on with clip, from its first frame at the next step if it wasn't
+// playing it already. The pose shown stays until then.
+void Animation_Play(Animation_t *animation, uint8_t clip);
+
+// Moves the animation a tick
+// Returns 1 if the pose changed, and the entity must be drawn again
+bool Animation_Step(Animation_t *animation);
+
+#endif
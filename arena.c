@@ -0,0 +1,40 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "arena.h"
+
+// uint32_t so the buffer itself is aligned
+static uint32_t arena_buffer[ARENA_SIZE / 4];
+static uint16_t arena_used;
+static uint16_t arena_high;
+
+// =====================================================
+// ### ALLOCATION ###
+
+// Gives back everything, for a new level
+void Arena_Reset(void){
+    arena_used = 0;
+}
+
+// Takes bytes from the arena, aligned to ARENA_ALIGN
+// Returns NULL if the arena is full
+void *Arena_Alloc(uint16_t bytes){
+    void *block;
+
+    bytes = (bytes + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+    if(bytes > ARENA_SIZE - arena_used) return 0;
+
+    block = (uint8_t *)arena_buffer + arena_used;
+    arena_used += bytes;
+    if(arena_used > arena_high) arena_high = arena_used;
+    return block;
+}
+
+// Bytes taken in this level, and the most taken since the game started
+uint16_t Arena_Used(void){
+    return arena_used;
+}
+
+uint16_t Arena_High(void){
+    return arena_high;
+}
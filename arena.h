@@ -0,0 +1,32 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =====================================================
+// Level arena
+// The storage of what lives as long as a level (the enemies, projectiles
+// and effects, with their pools of pool.h) is taken from one static buffer
+// by moving a pointer, and given back all at once by Arena_Reset when a new
+// level starts. Nothing is freed on its own, so there is no fragmentation
+// and a reset is O(1).
+// arena_high tells how much of ARENA_SIZE the levels really need.
+#define ARENA_SIZE      2048
+#define ARENA_ALIGN     4
+
+// =====================================================
+// ### ALLOCATION ###
+
+// Gives back everything, for a new level
+void Arena_Reset(void);
+
+// Takes bytes from the arena, aligned to ARENA_ALIGN
+// Returns NULL if the arena is full
+void *Arena_Alloc(uint16_t bytes);
+
+// Bytes taken in this level, and the most taken since the game started
+uint16_t Arena_Used(void);
+uint16_t Arena_High(void);
+
+#endif
@@ -0,0 +1,113 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "behavior.h"
+#include "paths.h"
+#include "profile.h"
+
+// =====================================================
+// ### INTERPRETER ###
+
+// Runs the program of an enemy until it acts
+// Returns BEHAVIOR_MOVE (a step towards *direction), BEHAVIOR_PATH
+// (a step of dx, dy), BEHAVIOR_CHASE, BEHAVIOR_FACE (stays, looking to
+// *direction), BEHAVIOR_SHOOT or BEHAVIOR_WAIT
+uint8_t Behavior_Run(const uint8_t *program, Behavior_t *state, uint8_t life, uint8_t *direction, int8_t *dx, int8_t *dy){
+    const uint8_t *op;
+    uint8_t budget;
+    uint8_t step;                   // step of a path, x and y nibbles
+    uint8_t action = BEHAVIOR_END;  // END until an opcode acts
+    PROFILE_BEGIN();
+
+    for(budget=BEHAVIOR_BUDGET;budget && action==BEHAVIOR_END;budget--){
+        op = &program[state->pc];
+
+        switch(op[0]){
+            case BEHAVIOR_END:
+                state->pc = 0;
+                break;
+
+            case BEHAVIOR_MOVE:
+            case BEHAVIOR_FACE:
+                *direction = op[1];
+                state->pc += 2;
+                action = op[0];
+                break;
+
+            // one time in five it stays, looking up
+            case BEHAVIOR_WANDER:
+                *direction = rand()%5;
+                if(*direction > LEFT){
+                    *direction = UP;
+                    action = BEHAVIOR_FACE;
+                }else{
+                    action = BEHAVIOR_MOVE;
+                }
+                state->pc += 1;
+                break;
+
+            case BEHAVIOR_CHASE:
+            case BEHAVIOR_SHOOT:
+                state->pc += 1;
+                action = op[0];
+                break;
+
+            case BEHAVIOR_WAIT:
+                if(!state->wait) state->wait = op[1] ? op[1] : 1;
+                if(!--state->wait) state->pc += 2;
+                action = BEHAVIOR_WAIT;
+                break;
+
+            // the path starts from its first step each time
+            case BEHAVIOR_PATH:
+                if(!state->wait){
+                    state->wait = op[2] ? op[2] : 1;
+                    state->phase = 0;
+                }
+                step = path_step[op[1]][state->phase];
+                state->phase = (state->phase + 1) & (PATH_STEPS - 1);
+                *dx = (int8_t)step >> 4;
+                *dy = (int8_t)(step << 4) >> 4;
+                if(!--state->wait) state->pc += 3;
+                action = BEHAVIOR_PATH;
+                break;
+
+            case BEHAVIOR_LOOP:
+                if(!state->loop) state->loop = op[1] + 1;
+                if(--state->loop) state->pc = op[2];
+                else state->pc += 3;
+                break;
+
+            case BEHAVIOR_RANDOM:
+                if((rand() & 0xFF) < op[1]) state->pc = op[2];
+                else state->pc += 3;
+                break;
+
+            // a new phase, the loop it was in is over
+            case BEHAVIOR_LIFE:
+                if(life <= op[1]){
+                    state->pc = op[2];
+                    state->loop = 0;
+                }else{
+                    state->pc += 3;
+                }
+                break;
+
+            case BEHAVIOR_JUMP:
+                state->pc = op[1];
+                break;
+
+            // not an opcode, the program starts over
+            default:
+                state->pc = 0;
+                break;
+        }
+    }
+
+    PROFILE_END(PROFILE_BEHAVIOR);
+
+    // out of budget
+    if(action==BEHAVIOR_END) return BEHAVIOR_WAIT;
+    return action;
+}
@@ -0,0 +1,66 @@
+#ifndef BEHAVIOR_H
+#define BEHAVIOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "definitions.h"
+
+// =====================================================
+// Enemy behavior programs
+// A program is a byte string of opcodes, each followed by its operands.
+// Every time the enemy moves, Behavior_Run goes on from where it stopped
+// until an opcode that acts (MOVE, WANDER, CHASE, PATH, FACE, WAIT,
+// SHOOT), so a pattern over many moves costs one opcode or a few per move.
+// The enemy keeps its place in the program in Enemies_t.behavior. There is
+// one loop counter for each enemy, so loops don't nest.
+//
+//  opcode              operands    what the enemy does
+//  BEHAVIOR_END                    starts the program over
+//  BEHAVIOR_MOVE       dir         a step towards dir [UP, RIGHT, DOWN, LEFT]
+//  BEHAVIOR_WANDER                 a step in a random direction, or looks up
+//  BEHAVIOR_CHASE                  a step towards Link
+//  BEHAVIOR_PATH       path, n     the first n steps of a trajectory, one a move
+//  BEHAVIOR_FACE       dir         looks to dir without moving
+//  BEHAVIOR_WAIT       n           stays still for n moves
+//  BEHAVIOR_SHOOT                  stays still and fires a feather at Link
+//  BEHAVIOR_LOOP       n, to       goes back to the byte to, n times
+//  BEHAVIOR_RANDOM     p, to       goes to the byte to, p times in 256
+//  BEHAVIOR_LIFE       n, to       goes to the byte to if its life is n or less
+//  BEHAVIOR_JUMP       to          goes to the byte to
+#define BEHAVIOR_END        0
+#define BEHAVIOR_MOVE       1
+#define BEHAVIOR_WANDER     2
+#define BEHAVIOR_CHASE      3
+#define BEHAVIOR_FACE       4
+#define BEHAVIOR_WAIT       5
+#define BEHAVIOR_LOOP       6
+#define BEHAVIOR_RANDOM     7
+#define BEHAVIOR_LIFE       8
+#define BEHAVIOR_JUMP       9
+#define BEHAVIOR_PATH       10
+#define BEHAVIOR_SHOOT      11
+
+// Trajectories of BEHAVIOR_PATH, closed curves of PATH_STEPS steps
+// The tables are in paths.h, generated by paths.py
+#define PATH_CIRCLE         0   // 16 pixels wide, clockwise from the top
+#define PATH_EIGHT          1   // 24 pixels wide and 12 high
+#define PATH_DIVE           2   // 16 pixels down fast and back up slowly
+#define PATH_ZIGZAG         3   // four teeth 24 pixels right and back
+#define PATHS               4
+#define PATH_STEPS          32
+
+// Opcodes run for a move at most, the enemy waits if the budget runs out
+// An enemy costs at most this much in a level tick
+#define BEHAVIOR_BUDGET     8
+
+// =====================================================
+// ### INTERPRETER ###
+
+// Runs the program of an enemy until it acts
+// Returns BEHAVIOR_MOVE (a step towards *direction), BEHAVIOR_PATH
+// (a step of dx, dy), BEHAVIOR_CHASE, BEHAVIOR_FACE (stays, looking to
+// *direction), BEHAVIOR_SHOOT or BEHAVIOR_WAIT
+uint8_t Behavior_Run(const uint8_t *program, Behavior_t *state, uint8_t life, uint8_t *direction, int8_t *dx, int8_t *dy);
+
+#endif
@@ -925,6 +925,11 @@ const unsigned char *link_attack[]={
     link_up_attack, link_right_attack, link_down_attack, link_left_attack,
 };
 
+// [ATTACKING, WALKING, WALKING+1]
+const unsigned char **link_array[]={
+    link_attack, link_walk_1, link_walk_2,
+};
+
 // =====================================================
 // ### SWORD SPRITES ####
 
@@ -1007,13 +1012,17 @@ const unsigned char *sword_half_sprite[]={
     sword_half_up, sword_half_right, sword_half_down, sword_half_left,
 };
 
-// Defines where the sword sould appear with the direction
-int sword_position_x[]={
-    8,14,8,-16,
+// Sword of each attack frame and direction
+const unsigned char **sword_frame_sprite[SWORD_FRAMES]={
+    sword_half_sprite, sword_sprite,
 };
 
-int sword_position_y[]={
-    -15,-1,15,-1,
+// Where the sword of each attack frame appears from Link, and what it hits
+// The hitbox is only clipped by the screen, a shorter sword drawn near the
+// borders doesn't change the reach
+const Hitbox_t sword_box[SWORD_FRAMES][4]={
+    {{8,-15,6,9}, {14,-1,10,6}, {8,8,6,9},  {-10,-1,10,6}},
+    {{8,-15,6,15},{14,-1,16,6}, {8,15,6,15},{-16,-1,16,6}},
 };
 
 // =====================================================
@@ -1624,10 +1633,52 @@ const unsigned char **madcucco_array[]={
 };
 
 // =====================================================
-// ### ENEMY ARRAY ####
+// ### SWARM CUCCO SPRITES ####
+// SWARM_WIDTH x SWARM_HEIGHT (swarm.h), wings up and down
+
+const unsigned char swarm_cucco_1[] ={
+    0x42, 0x4D, 0x8A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x76, 0x00, 0x00, 0x00, 0x28, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x01, 0x00, 0x04, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x80,
+    0x00, 0x00, 0x00, 0x80, 0x80, 0x00, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00, 0x80, 0x00, 0x80, 0x80, 0x00, 0x00, 0x80, 0x80, 0x80, 0x00, 0xC0, 0xC0, 0xC0, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0xFF,
+    0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0xFF, 0x00, 0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x0F, 0xFF,
+    0xF0, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xF0, 0x00, 0x0F, 0x00,
+};
+
+const unsigned char swarm_cucco_2[] ={
+    0x42, 0x4D, 0x8A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x76, 0x00, 0x00, 0x00, 0x28, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x01, 0x00, 0x04, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x80,
+    0x00, 0x00, 0x00, 0x80, 0x80, 0x00, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00, 0x80, 0x00, 0x80, 0x80, 0x00, 0x00, 0x80, 0x80, 0x80, 0x00, 0xC0, 0xC0, 0xC0, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0xFF,
+    0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0xFF, 0x00, 0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x00, 0xF0, 0x00, 0x0F, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0x0F, 0xFF,
+    0xF0, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+const unsigned char *swarm_sprite[]={
+    swarm_cucco_1, swarm_cucco_2,
+};
+
+// =====================================================
+// ### PROJECTILE SPRITES ####
+// The sword beam flies as sword_half_sprite, the grand cucco shoots feathers
 
-const unsigned char ***enemy_array[]={
-    grass_array, cucco_array, grand_cucco_array, oldman_array, grand_madcucco_array, madcucco_array
+const unsigned char feather[] ={
+    0x42, 0x4D, 0x86, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x76, 0x00, 0x00, 0x00, 0x28, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x01, 0x00, 0x04, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x80,
+    0x00, 0x00, 0x00, 0x80, 0x80, 0x00, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00, 0x80, 0x00, 0x80, 0x80, 0x00, 0x00, 0x80, 0x80, 0x80, 0x00, 0xC0, 0xC0, 0xC0, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0xFF,
+    0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0xFF, 0x00, 0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x00, 0xF0, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0x0F, 0xF0,
+    0x00, 0x00, 0x00, 0xFF, 0x00, 0x00,
+};
+
+// =====================================================
+// ### EFFECT SPRITES ####
+// Drawn over what is under them, see Level_Effects. Cuccos that are hit
+// lose a feather too
+
+const unsigned char spark[] ={
+    0x42, 0x4D, 0x86, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x76, 0x00, 0x00, 0x00, 0x28, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x01, 0x00, 0x04, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x80,
+    0x00, 0x00, 0x00, 0x80, 0x80, 0x00, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00, 0x80, 0x00, 0x80, 0x80, 0x00, 0x00, 0x80, 0x80, 0x80, 0x00, 0xC0, 0xC0, 0xC0, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0xFF,
+    0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0xFF, 0x00, 0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x00, 0xF0, 0x0F, 0x00, 0x00, 0x0F, 0xF0, 0x00, 0x00, 0x0F, 0xF0,
+    0x00, 0x00, 0xF0, 0x0F, 0x00, 0x00,
 };
 
 const unsigned char vooo[] ={
@@ -1,4 +1,6 @@
 #include "buttons.h"
+#include "clock.h"
+#include "rtos.h"
 
 #include "inc/hw_gpio.h"
 #include "driverlib/gpio.h"
@@ -9,14 +11,16 @@
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
 
+#ifndef WRITE_REG
 #define WRITE_REG(x)                      (*((volatile uint32_t *)(x)))
+#endif
 
 void ConfigureButtons()
 {
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOF);
 
-    SysCtlDelay(SysCtlClockGet() / 4);
+    Clock_DelayMs(750);
 
     WRITE_REG(GPIO_PORTF_BASE + GPIO_O_LOCK) = GPIO_LOCK_KEY;
     WRITE_REG(GPIO_PORTF_BASE + GPIO_O_CR)   = 0x01;
@@ -42,7 +46,8 @@ uint8_t GetColumn()
 }
 
 
-uint8_t GetButton()
+// Reads the keypad, returns the code of the first key found pressed
+uint8_t ScanButtons()
 {
     uint8_t i;
     uint8_t Column;
@@ -94,3 +99,15 @@ uint8_t GetButton()
 
     return BUTTON_NOT_PRESSED;
 }
+
+
+// Returns the key being pressed
+// RTOS builds read the last key scanned by the input task
+uint8_t GetButton()
+{
+#ifdef RTOS
+    return Rtos_GetButton();
+#else
+    return ScanButtons();
+#endif
+}
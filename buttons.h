@@ -5,8 +5,10 @@
 #include <stdbool.h>
 
 #define BUTTON_NOT_PRESSED 99
+#define BUTTON_SCAN_MS     10   // keypad scan period of the RTOS input task
 
 void    ConfigureButtons();
+uint8_t ScanButtons();
 uint8_t GetButton();
 
 #endif
@@ -0,0 +1,122 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/systick.h"
+#include "driverlib/interrupt.h"
+
+#include "clock.h"
+#include "rtos.h"
+#include "Nokia5110.h"
+
+#ifdef RTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+// =====================================================
+// Run mode description
+typedef struct{
+    uint32_t config;                    // SysCtlClockSet configuration
+    uint32_t hz;                        // resulting system clock
+} Clock_Mode_t;
+
+// 400 MHz PLL, divided by 2 and then by SYSDIV
+static const Clock_Mode_t clock_modes[] = {
+    {SYSCTL_SYSDIV_2_5 | SYSCTL_USE_PLL | SYSCTL_XTAL_16MHZ | SYSCTL_OSC_MAIN, 80000000},  // CLOCK_RUN
+    {SYSCTL_SYSDIV_16  | SYSCTL_USE_PLL | SYSCTL_XTAL_16MHZ | SYSCTL_OSC_MAIN, 12500000},  // CLOCK_IDLE
+};
+
+static uint8_t clock_mode = CLOCK_RUN;
+static uint32_t clock_hz = 80000000;
+
+// incremented by SysTick every millisecond
+// RTOS builds use the scheduler tick instead
+static volatile uint32_t clock_millis = 0;
+
+// =====================================================
+// ### CLOCK MANAGEMENT ###
+
+// Configures the system clock, the SysTick timebase and the display link
+void Clock_Init(uint8_t mode){
+    clock_millis = 0;
+
+    // forces the first configuration
+    clock_mode = !mode;
+    Clock_SetMode(mode);
+
+    // SysTick drives the millisecond timebase
+    // Its current value is also used as a random seed
+    // RTOS builds call this from a task, the scheduler already runs SysTick
+    #ifndef RTOS
+    SysTickEnable();
+    SysTickIntEnable();
+    IntMasterEnable();
+    #endif
+}
+
+// Changes the system clock and keeps the timebase and the display link in step
+void Clock_SetMode(uint8_t mode){
+    if(mode == clock_mode) return;
+
+    // the render task must not be sending while the SSI clock changes
+    Rtos_LcdTake();
+
+    // the SSI baud clock comes from the system clock: while it changes, the
+    // prescaler is the one of the faster clock, so the display link never
+    // goes over its maximum
+    if(clock_modes[mode].hz > clock_hz) Nokia5110_SetSysClock(clock_modes[mode].hz);
+
+    clock_mode = mode;
+    clock_hz = clock_modes[mode].hz;
+
+    SysCtlClockSet(clock_modes[mode].config);
+    SysTickPeriodSet(clock_hz / CLOCK_TICK_HZ);
+
+    // a slower clock lowers the prescaler once it runs
+    Nokia5110_SetSysClock(clock_hz);
+
+    Rtos_LcdGive();
+}
+
+// Returns the current run mode
+uint8_t Clock_GetMode(){
+    return clock_mode;
+}
+
+// Returns the current system clock in Hz
+uint32_t Clock_GetHz(){
+    return clock_hz;
+}
+
+// =====================================================
+// ### TIMEBASE ###
+
+// Milliseconds elapsed since Clock_Init
+uint32_t Clock_Millis(){
+    #ifdef RTOS
+    return xTaskGetTickCount();
+    #else
+    return clock_millis;
+    #endif
+}
+
+// Busy waits for the given time, whatever the system clock is
+// The clock may even change while waiting
+// RTOS builds block the calling task instead
+void Clock_DelayMs(uint32_t ms){
+    #ifdef RTOS
+    vTaskDelay(pdMS_TO_TICKS(ms));
+    #else
+    uint32_t start = clock_millis;
+    while(clock_millis - start < ms){}
+    #endif
+}
+
+// SysTick interrupt handler, placed in the vector table
+// RTOS builds place the FreeRTOS one instead
+void Clock_SysTickHandler(void){
+    clock_millis++;
+}
@@ -0,0 +1,43 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =====================================================
+// Run modes
+#define CLOCK_RUN       0   // 80 MHz, while the game is being played
+#define CLOCK_IDLE      1   // 12.5 MHz, while waiting for the player
+
+// SysTick timebase resolution
+#define CLOCK_TICK_HZ   1000
+
+// =====================================================
+// ### CLOCK MANAGEMENT ###
+
+// Configures the system clock, the SysTick timebase and the display link
+void Clock_Init(uint8_t mode);
+
+// Changes the system clock and keeps the timebase and the display link in step
+void Clock_SetMode(uint8_t mode);
+
+// Returns the current run mode
+uint8_t Clock_GetMode();
+
+// Returns the current system clock in Hz
+uint32_t Clock_GetHz();
+
+// =====================================================
+// ### TIMEBASE ###
+
+// Milliseconds elapsed since Clock_Init
+uint32_t Clock_Millis();
+
+// Busy waits for the given time, whatever the system clock is
+// RTOS builds block the calling task instead
+void Clock_DelayMs(uint32_t ms);
+
+// SysTick interrupt handler, placed in the vector table
+void Clock_SysTickHandler(void);
+
+#endif
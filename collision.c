@@ -0,0 +1,200 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "collision.h"
+#include "ramfunc.h"
+#include "profile.h"
+#include "Nokia5110.h"
+
+// =====================================================
+// Box of an entity, an empty box (w = 0) is not in the level
+typedef struct{
+    uint8_t x;                          // left column
+    uint8_t y;                          // bottom row
+    uint8_t w;                          // width, 0 if the box is empty
+    uint8_t h;                          // height
+    const unsigned char *sprite;        // sprite the box was taken from
+} Collision_Box_t;
+
+static Collision_Box_t collision_box[COLLISION_BOXES];
+
+// Events of the tick, oldest first from collision_first
+static Collision_Event_t collision_event[COLLISION_EVENTS];
+static uint8_t collision_first;
+static uint8_t collision_events;
+
+// =====================================================
+// ### BOXES ###
+
+// Removes all the boxes and the events not taken yet
+void Collision_Clear(void){
+    uint8_t i;
+    for(i=0;i<COLLISION_BOXES;i++){
+        collision_box[i].w = 0;
+    }
+    collision_first = 0;
+    collision_events = 0;
+}
+
+// Sets the box of an entity to the size of its sprite at (x, y)
+// A NULL sprite removes the box
+void Collision_Set(uint8_t id, uint8_t x, uint8_t y, const unsigned char *sprite){
+    if(!sprite){
+        collision_box[id].w = 0;
+        return;
+    }
+    collision_box[id].x = x;
+    collision_box[id].y = y;
+    collision_box[id].w = Nokia5110_getWidth(sprite);
+    collision_box[id].h = Nokia5110_getHeight(sprite);
+    collision_box[id].sprite = sprite;
+}
+
+// Sets the box of an entity without a sprite, only the box is tested
+void Collision_SetBox(uint8_t id, uint8_t x, uint8_t y, uint8_t w, uint8_t h){
+    collision_box[id].x = x;
+    collision_box[id].y = y;
+    collision_box[id].w = w;
+    collision_box[id].h = h;
+    collision_box[id].sprite = 0;
+}
+
+// Removes the box of an entity
+void Collision_Remove(uint8_t id){
+    collision_box[id].w = 0;
+}
+
+// =====================================================
+// ### QUERIES ###
+
+// Returns the first id from first to last - 1, other than skip, whose box
+// touches box, COLLISION_NONE if there is none
+// The boxes are compared first, only overlapping ones with sprites are compared pixel by pixel
+RAMFUNC static uint8_t Collision_Search(const Collision_Box_t *box, uint8_t skip, uint8_t first, uint8_t last){
+    const Collision_Box_t *other;
+    uint8_t i;
+    uint8_t hit = COLLISION_NONE;
+
+    PROFILE_BEGIN();
+
+    if(box->w){
+        for(i=first;i<last;i++){
+            other = &collision_box[i];
+            if(i==skip || !other->w) continue;
+            if(!Collision_Overlaps(box->x, box->y, box->w, box->h, other->x, other->y, other->w, other->h)) continue;
+            if(!box->sprite || !other->sprite ||
+               Collision_Pixels(box->sprite, box->x, box->y, other->sprite, other->x, other->y)){
+                hit = i;
+                break;
+            }
+        }
+    }
+
+    PROFILE_END(PROFILE_COLLISION);
+
+    return hit;
+}
+
+// Returns the first id from first to last - 1 whose sprite touches the sprite of id,
+// COLLISION_NONE if there is none
+RAMFUNC uint8_t Collision_Check(uint8_t id, uint8_t first, uint8_t last){
+    return Collision_Search(&collision_box[id], id, first, last);
+}
+
+// Returns the first id from first to last - 1 whose sprite touches sprite at (x, y),
+// COLLISION_NONE if there is none
+// For what has no box of its own, like the projectiles
+uint8_t Collision_Query(const unsigned char *sprite, uint8_t x, uint8_t y, uint8_t first, uint8_t last){
+    Collision_Box_t box;
+
+    box.x = x;
+    box.y = y;
+    box.w = Nokia5110_getWidth(sprite);
+    box.h = Nokia5110_getHeight(sprite);
+    box.sprite = sprite;
+    return Collision_Search(&box, COLLISION_NONE, first, last);
+}
+
+// Returns 1 if two sprite rectangles overlap, (x, y) being the bottom left corner
+RAMFUNC bool Collision_Overlaps(uint8_t x1, uint8_t y1, uint8_t w1, uint8_t h1, uint8_t x2, uint8_t y2, uint8_t w2, uint8_t h2){
+    return x1 < x2 + w2 && x2 < x1 + w1 && y1 - h1 < y2 && y2 - h2 < y1;
+}
+
+// =====================================================
+// ### EVENTS ###
+
+// Records that id touched hit, once per pair until it is taken
+// Returns 0 if the queue is full and the event was lost
+bool Collision_Post(uint8_t id, uint8_t hit){
+    Collision_Event_t *event;
+    uint8_t i;
+
+    for(i=0;i<collision_events;i++){
+        event = &collision_event[(collision_first + i) % COLLISION_EVENTS];
+        if(event->id==id && event->hit==hit) return 1;
+    }
+
+    if(collision_events==COLLISION_EVENTS) return 0;
+
+    event = &collision_event[(collision_first + collision_events) % COLLISION_EVENTS];
+    event->id = id;
+    event->hit = hit;
+    collision_events++;
+    return 1;
+}
+
+// Takes the oldest event out of the queue
+// Returns 0 if there are no events
+bool Collision_Take(Collision_Event_t *event){
+    if(!collision_events) return 0;
+
+    *event = collision_event[collision_first];
+    collision_first = (collision_first + 1) % COLLISION_EVENTS;
+    collision_events--;
+    return 1;
+}
+
+// =====================================================
+// ### PIXELS ###
+
+// Row of a sprite as a 1bpp mask, bit i is the pixel of column i
+// Row 0 is the bottom one, BMP rows are stored bottom up and padded to 32 bits
+RAMFUNC static uint32_t Collision_Row(const unsigned char *sprite, uint8_t row){
+    uint8_t width = sprite[18];
+    const unsigned char *pixel = sprite + sprite[10] + row * (((width / 2) + 3) & ~3);
+    uint32_t mask = 0;
+    uint8_t i;
+
+    // two pixels a byte, the left one in the upper 4 bits
+    for(i=0;i<width;i+=2, pixel++){
+        if(*pixel & 0xF0) mask |= 1UL << i;
+        if(*pixel & 0x0F) mask |= 1UL << (i+1);
+    }
+    return mask;
+}
+
+// Returns 1 if a lit pixel of a sprite at (x1, y1) is over a lit pixel of another at (x2, y2)
+// The rows both sprites share are turned into masks, aligned and ANDed
+RAMFUNC bool Collision_Pixels(const unsigned char *sprite1, uint8_t x1, uint8_t y1, const unsigned char *sprite2, uint8_t x2, uint8_t y2){
+    int16_t top, bottom, y;
+    uint32_t row1, row2;
+
+    // too far apart for sprites up to 32 pixels wide
+    if(x1 >= x2 + 32 || x2 >= x1 + 32) return 0;
+
+    // rows covered by both sprites
+    bottom = y1 < y2 ? y1 : y2;
+    top = y1 - sprite1[22] > y2 - sprite2[22] ? y1 - sprite1[22] : y2 - sprite2[22];
+
+    for(y=bottom;y>top;y--){
+        row1 = Collision_Row(sprite1, y1 - y);
+        row2 = Collision_Row(sprite2, y2 - y);
+
+        // column x of the screen is bit x - x1 of row1 and x - x2 of row2
+        if(x2 >= x1) row2 <<= x2 - x1;
+        else row1 <<= x1 - x2;
+
+        if(row1 & row2) return 1;
+    }
+    return 0;
+}
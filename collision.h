@@ -0,0 +1,82 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =====================================================
+// Collision boxes
+// Every entity of the level has a box slot, found by its id. A box is the
+// sprite rectangle, (x, y) being the bottom left corner like in
+// Nokia5110_PrintBMP. The boxes are tested against each other, so a query
+// answers with the id of the entity that was hit. Boxes that overlap are then
+// tested pixel by pixel when both have a sprite, so blank corners of the
+// sprites don't hit.
+#define COLLISION_LINK      0   // Link
+#define COLLISION_SWORD     1   // Link's sword, only while attacking, a bare box
+#define COLLISION_ENEMY     2   // first enemy, enemy m of the level is COLLISION_ENEMY + m
+#define COLLISION_ENEMIES   64  // enemies a level can hold, COLLISION_BOXES up to 251
+#define COLLISION_BOXES     (COLLISION_ENEMY + COLLISION_ENEMIES)
+
+#define COLLISION_NONE      0xFF    // nothing was hit
+
+// Collision events, one for each pair that touched in a level tick
+// Link and an enemy are always recorded as (COLLISION_LINK, enemy). What has
+// no box of its own posts its hits with an id of the events only.
+#define COLLISION_PECK      COLLISION_BOXES     // a swarm cucco pecked Link, hit is COLLISION_LINK
+#define COLLISION_BEAM      (COLLISION_BOXES+1) // a sword beam hit an enemy
+#define COLLISION_FEATHER   (COLLISION_BOXES+2) // a feather hit Link, hit is COLLISION_LINK
+#define COLLISION_EVENTS    (3 * COLLISION_ENEMIES + 2)
+
+typedef struct{
+    uint8_t id;                         // what moved, Link or his sword, or an id of the events only
+    uint8_t hit;                        // what it touched, an enemy, or Link
+} Collision_Event_t;
+
+// =====================================================
+// ### BOXES ###
+
+// Removes all the boxes and the events not taken yet
+void Collision_Clear(void);
+
+// Sets the box of an entity to the size of its sprite at (x, y)
+// A NULL sprite removes the box
+void Collision_Set(uint8_t id, uint8_t x, uint8_t y, const unsigned char *sprite);
+
+// Sets the box of an entity without a sprite, only the box is tested
+void Collision_SetBox(uint8_t id, uint8_t x, uint8_t y, uint8_t w, uint8_t h);
+
+// Removes the box of an entity
+void Collision_Remove(uint8_t id);
+
+// =====================================================
+// ### QUERIES ###
+
+// Returns the first id from first to last - 1 whose sprite touches the sprite of id,
+// COLLISION_NONE if there is none
+uint8_t Collision_Check(uint8_t id, uint8_t first, uint8_t last);
+
+// Returns the first id from first to last - 1 whose sprite touches sprite at (x, y),
+// COLLISION_NONE if there is none
+// For what has no box of its own, like the projectiles
+uint8_t Collision_Query(const unsigned char *sprite, uint8_t x, uint8_t y, uint8_t first, uint8_t last);
+
+// Returns 1 if two sprite rectangles overlap, (x, y) being the bottom left corner
+bool Collision_Overlaps(uint8_t x1, uint8_t y1, uint8_t w1, uint8_t h1, uint8_t x2, uint8_t y2, uint8_t w2, uint8_t h2);
+
+// Returns 1 if a lit pixel of a sprite at (x1, y1) is over a lit pixel of another at (x2, y2)
+// Sprites are up to 32 pixels wide
+bool Collision_Pixels(const unsigned char *sprite1, uint8_t x1, uint8_t y1, const unsigned char *sprite2, uint8_t x2, uint8_t y2);
+
+// =====================================================
+// ### EVENTS ###
+
+// Records that id touched hit, once per pair until it is taken
+// Returns 0 if the queue is full and the event was lost
+bool Collision_Post(uint8_t id, uint8_t hit);
+
+// Takes the oldest event out of the queue
+// Returns 0 if there are no events
+bool Collision_Take(Collision_Event_t *event);
+
+#endif
@@ -4,6 +4,9 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "collision.h"
+#include "pool.h"
+
 // =====================================================
 
 #define PAUSE       5 
@@ -19,6 +22,9 @@
 #define WALKING     1
 #define HURT        2
 
+// Frames of Link's attack, the sword grows from half to full length
+#define SWORD_FRAMES    2
+
 // Enemy attacked animation
 #define ATTACKED1   4
 #define ATTACKED2   5
@@ -27,15 +33,35 @@
 #define DUMB        0
 #define ACTIVE      1
 #define FOLLOWER    2
-
-// Warmap status
-#define FREE        0   // there's nothing in this place
-#define ENEMY       1   // there's an enemy in this spot
-#define LINK        8   // Link is there
-#define SWORD       16   // Link's sword is there
-
-#define LOSE        9   // some moster attacked Link
-#define WIN         17  // Link attacked some monster
+#define STATUSES    3
+
+// Link's sword, the attack switch
+#define SWORD       16
+
+// Cucco revenge: anger that calls the swarm, and level ticks between two
+// swarm pecks on Link
+#define SWARM_ANGER     12
+#define SWARM_PECK      20
+
+// Link's box and where he starts a level, its bottom left corner
+#define LINK_START_X    1
+#define LINK_START_Y    33
+#define LINK_WIDTH      14
+#define LINK_HEIGHT     16
+
+// Projectiles (projectile.h): Link's full life, when his sword shoots a beam,
+// and the speed of each shot, in 1/16 pixels a tick, and its life in ticks
+#define LINK_LIFE       6
+#define BEAM_SPEED      48
+#define BEAM_LIFE       24
+#define FEATHER_SPEED   24
+#define FEATHER_LIFE    48
+
+// Effects (effect.h): level ticks of each defeat frame and of a spark, and
+// frames of a feather lost by a cucco
+#define DEFEAT_TICKS    4
+#define SPARK_TICKS     3
+#define FEATHER_FALL    6
 
 // Enemy code
 #define GRASS           0
@@ -44,54 +70,136 @@
 #define OLDMAN          3
 #define GRAND_MADCUCCO  4
 #define MADCUCCO        5
+#define ANGRY_CUCCO     6
+#define ENEMY_TYPES     7
+
 
 
+// =====================================================
+// Box relative to a character, (x, y) being the bottom left corner
+typedef struct{
+    int8_t x;                          // x offset from the character
+    int8_t y;                          // y offset from the character
+    uint8_t w;                         // width
+    uint8_t h;                         // height
+} Hitbox_t;
+
+// =====================================================
+// Place of an enemy in its behavior program (behavior.h)
+typedef struct{
+    uint8_t pc;                        // next opcode
+    uint8_t wait;                      // moves left of a BEHAVIOR_WAIT or BEHAVIOR_PATH
+    uint8_t loop;                      // jumps left of a BEHAVIOR_LOOP
+    uint8_t phase;                     // next step of a BEHAVIOR_PATH
+} Behavior_t;
+
+// =====================================================
+// Place of Link or an enemy in its animation clip (animation.h)
+typedef struct{
+    uint8_t clip;                      // clip playing
+    uint8_t frame;                     // frame of the clip
+    uint8_t wait;                      // ticks left of the frame, 0 holds it
+    uint8_t pose;                      // step of the sprite sheet shown
+} Animation_t;
+
+// =====================================================
+// Enemy archetype, one for each enemy code (enemy_archetype in actions.c)
+typedef struct{
+    const unsigned char ***sprite;     // sprite sheet, two steps
+    uint8_t w;                         // width of the sprites
+    uint8_t h;                         // height of the sprites
+    uint8_t life;                      // life of a new enemy
+    uint8_t damage;                    // how much damage the enemy causes to Link
+    uint8_t anger;                     // anger of the cuccos each time it's hit
+    uint8_t behavior;                  // movement style [DUMB, ACTIVE, FOLLOWER]
+    const uint8_t *program;            // behavior program, run at each move
+    uint8_t period;                    // level ticks between moves, 0 never moves
+    uint8_t speed;                     // pixels of a move
+    uint8_t walk;                      // animation clip while it moves
+    uint8_t idle;                      // animation clip while it stands
+} Archetype_t;
 
 // =====================================================
 // Main character structure
 typedef struct{
     uint8_t x;                         // x coordinate
     uint8_t y;                         // y coordinate
-    const unsigned char **sprite[3];   // pointer to the hero sprite sheet
     const unsigned char *last_sprite;  // pointer to the last hero sprite
     const unsigned char *sword;        // pointer to the last sword sprite
     uint8_t size_x;                    // horizontal size of the actual sprite
     uint8_t size_y;                    // vertical size of the actual sprite
     int life;                          // life counter. Goes from 6(full) to 0(dead)
     bool status;                       // 1 is walking. 0 is attacking. 2 is being hurt
-    bool step;                         // alternates to make walking effect
+    Animation_t animation;             // walking step, see Level_Animate
     uint8_t direction;                 // to where Link is looking [UP, RIGHT, DOWN, LEFT]
     uint8_t enemies_to_kill;           // how much enemies Link must kill in the level
+    uint8_t attack;                    // attack frames shown, 0 when not attacking
 } Link_t;
 
 // =====================================================
-// Standard enemy structure
+// Enemies of a level, as a structure of arrays: enemy m is slot m of each
+// array, so a loop only brings in the fields it reads
+// The slots are handed out by a pool (pool.h), and the level loops only go
+// through its live slots, in the order they were created. The arrays are
+// taken from the level arena (arena.h). A slot takes 16 bytes here and a
+// collision box (collision.h); the frame cost of each enemy is in README.md
+#define ENEMIES         COLLISION_ENEMIES
+#define ENEMY_NONE      POOL_NONE       // no free slot
+
+// flags
+#define ENEMY_STATUS    0x03            // movement style [DUMB, ACTIVE, FOLLOWER]
+#define ENEMY_ALIVE     0x04            // the slot has an enemy on the screen
+#define ENEMY_BAKED     0x08            // never moves, drawn in the background (see Level_Enter)
+#define ENEMY_STRUCK    0x10            // hit by the current swing of the sword
+#define ENEMY_TOUCHED   0x20            // touched Link in this tick
+#define ENEMY_ERASED    0x40            // a swarm cucco, a projectile or an effect was drawn over it
+
 typedef struct{
-    uint8_t x;                         // x coordinate
-    uint8_t y;                         // y coordinate
-    const unsigned char **sprite[2];   // pointer to the enemy sprite sheet
-    const unsigned char *last_sprite;  // pointer to the last enemy sprite
-    uint8_t size_x;                    // horizontal size of the actual sprite
-    uint8_t size_y;                    // vertical size of the actual sprite
-    uint8_t life;                          // life counter (it depends from the enemy)
-    uint8_t damage;                    // how much damage the enemy causes to Link
-    uint8_t status;                       // 0 is steady. 1 is random walk. 2 follows link
-    bool step;                         // alternates to make walking effect
-    uint8_t direction;                 // to where the Enemy is looking [UP, RIGHT, DOWN, LEFT]
-} Enemy_t;
+    uint8_t x[ENEMIES];                 // x coordinate
+    uint8_t y[ENEMIES];                 // y coordinate
+    uint8_t type[ENEMIES];              // enemy code, its archetype
+    uint8_t anim[ENEMIES];              // frame of the sprite sheet shown [UP, RIGHT, DOWN, LEFT, ATTACKED1, ATTACKED2]
+    uint8_t hp[ENEMIES];                // life left
+    uint8_t flags[ENEMIES];             // ENEMY_STATUS, ENEMY_ALIVE, ENEMY_STRUCK...
+    Behavior_t behavior[ENEMIES];       // place in the behavior program
+    Animation_t animation[ENEMIES];     // place in the animation clip, the step of the frame
+    uint8_t next[ENEMIES];              // chains of the pool
+    uint8_t prev[ENEMIES];
+    Pool_t *pool;                       // live and free slots
+} Enemies_t;
+
+// =====================================================
+// Level records
+// A level as a record, in flash for the story mode: its monsters, how many of them must be
+// defeated and the cutscene played once it is finished. A monster comes in
+// delay level ticks after the one before it, the ones with no delay at the
+// start come with the level. Level_Load makes the running level out of it.
+#define CUTSCENE_NONE   0xFF            // nothing is played after the level
+
+typedef struct{
+    uint8_t type;                       // monster code [GRASS, CUCCO...], its behavior comes with it
+    uint8_t x;                          // bottom left corner, x SPAWN_ANYWHERE for a free place (spawn.h)
+    uint8_t y;
+    uint8_t delay;                      // level ticks after the monster before it, 0 with it
+} Level_Spawn_t;
+
+typedef struct{
+    const Level_Spawn_t *spawn;         // monsters, in the order they come
+    uint8_t spawns;                     // how many
+    uint8_t kills;                      // monsters to defeat to finish the level
+    uint8_t cutscene;                   // played once it is finished, CUTSCENE_NONE if none
+} Level_Def_t;
 
 // =====================================================
 // Level structure
 typedef struct{
     Link_t link;                        // the hero
-    Enemy_t *enemy_queue;               // a queue with all the level monsters
+    Enemies_t *enemy_queue;             // a queue with all the level monsters
     uint8_t enemy_amount;               // the number of enemies alive in the level
+    const Level_Def_t *def;             // record of the level, for the monsters coming in late
+    uint8_t spawned;                    // monsters of the record that came in
+    uint8_t spawn_wait;                 // level ticks until the next one comes
 } Level_t;
 
-
-// =====================================================
-
-uint8_t warmap[48][84]; // pointer to the warmap matrix
-
 #endif
 
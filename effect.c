@@ -0,0 +1,127 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "effect.h"
+#include "arena.h"
+#include "pool.h"
+#include "ramfunc.h"
+#include "Nokia5110.h"
+
+// =====================================================
+// Fields of the effects of a level, taken from the level arena
+typedef struct{
+    const unsigned char *first[EFFECTS];    // sprite of the even frames
+    const unsigned char *second[EFFECTS];   // sprite of the odd frames
+    uint8_t x[EFFECTS];                 // bottom left corner
+    uint8_t y[EFFECTS];
+    int8_t dx[EFFECTS];                 // move of each frame
+    int8_t dy[EFFECTS];
+    uint8_t frame[EFFECTS];             // frame shown
+    uint8_t steps[EFFECTS];             // frames to show
+    uint8_t period[EFFECTS];            // ticks of a frame
+    uint8_t wait[EFFECTS];              // ticks left of the frame shown
+    uint8_t next[EFFECTS];              // chains of the pool
+    uint8_t prev[EFFECTS];
+} Effects_t;
+
+static Effects_t *effect;               // NULL if the arena had no room
+static Pool_t effect_pool;
+
+// =====================================================
+// ### EFFECTS ###
+
+// Takes the effects of a new level from the level arena, with none playing
+// Call it after Arena_Reset
+void Effect_Reset(void){
+    effect = Arena_Alloc(sizeof(Effects_t));
+    if(effect) Pool_Init(&effect_pool, effect->next, effect->prev, EFFECTS);
+}
+
+// Plays first then second in turn at (x, y), their bottom left corner, for
+// steps frames of period ticks, moving (dx, dy) a frame
+// Returns the effect, EFFECT_NONE if there is no room
+uint8_t Effect_Play(uint8_t x, uint8_t y, const unsigned char *first, const unsigned char *second,
+                    uint8_t steps, uint8_t period, int8_t dx, int8_t dy){
+    uint8_t e;
+
+    if(!effect || !steps || !first) return EFFECT_NONE;
+
+    e = Pool_Take(&effect_pool);
+    if(e==POOL_NONE) return EFFECT_NONE;
+
+    effect->first[e] = first;
+    effect->second[e] = second ? second : first;
+    effect->x[e] = x;
+    effect->y[e] = y;
+    effect->dx[e] = dx;
+    effect->dy[e] = dy;
+    effect->frame[e] = 0;
+    effect->steps[e] = steps;
+    effect->period[e] = period ? period : 1;
+    effect->wait[e] = effect->period[e];
+    return e;
+}
+
+// Removes effect e
+void Effect_Kill(uint8_t e){
+    Pool_Give(&effect_pool, e);
+}
+
+// Effects playing, oldest first: Effect_First then Effect_Next until
+// EFFECT_NONE. e may be killed once its next one was read.
+uint8_t Effect_First(void){
+    if(!effect) return EFFECT_NONE;
+    return effect_pool.first;
+}
+
+uint8_t Effect_Next(uint8_t e){
+    return effect->next[e];
+}
+
+// Position of effect e, its bottom left corner, and the sprite of its frame
+void Effect_Position(uint8_t e, uint8_t *x, uint8_t *y){
+    *x = effect->x[e];
+    *y = effect->y[e];
+}
+
+const unsigned char *Effect_Sprite(uint8_t e){
+    return (effect->frame[e] & 1) ? effect->second[e] : effect->first[e];
+}
+
+// Most effects playing at once since the game started
+uint8_t Effect_High(void){
+    return effect_pool.high;
+}
+
+// =====================================================
+// ### ANIMATION ###
+
+// Ages every effect a tick, going to the next frame every period ticks and
+// removing the ones past their last frame or out of the screen
+RAMFUNC void Effect_Update(void){
+    const unsigned char *sprite;
+    uint8_t e, next;
+    int16_t x, y;
+
+    for(e=Effect_First();e!=EFFECT_NONE;e=next){
+        next = effect->next[e];
+
+        if(--effect->wait[e]) continue;
+        effect->wait[e] = effect->period[e];
+        if(++effect->frame[e]==effect->steps[e]){
+            Pool_Give(&effect_pool, e);
+            continue;
+        }
+
+        x = effect->x[e] + effect->dx[e];
+        y = effect->y[e] + effect->dy[e];
+        sprite = Effect_Sprite(e);
+        if(x < 0 || x + Nokia5110_getWidth(sprite) > 84 ||
+           y < Nokia5110_getHeight(sprite) - 1 || y > 47){
+            Pool_Give(&effect_pool, e);
+            continue;
+        }
+        effect->x[e] = x;
+        effect->y[e] = y;
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef EFFECT_H
+#define EFFECT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =====================================================
+// Effects
+// Short animations that don't take part in the game: defeat puffs, sparks
+// of the hits and feathers lost by the cuccos. An effect shows its two
+// sprites in turn for steps frames of period level ticks each, moving
+// (dx, dy) pixels a frame, and is gone after its last frame. Their fields
+// are arrays taken from the level arena, with a pool handing out the slots,
+// and Effect_Update ages all of them in one pass, so nothing waits for an
+// animation to end.
+// No more than EFFECT_DRAWS of them, the oldest ones, are drawn in a tick.
+#define EFFECTS             16
+#define EFFECT_DRAWS        8
+#define EFFECT_NONE         0xFF    // no effect, end of the list
+
+// =====================================================
+// ### EFFECTS ###
+
+// Takes the effects of a new level from the level arena, with none playing
+// Call it after Arena_Reset
+void Effect_Reset(void);
+
+// Plays first then second in turn at (x, y), their bottom left corner, for
+// steps frames of period ticks, moving (dx, dy) a frame
+// Returns the effect, EFFECT_NONE if there is no room
+uint8_t Effect_Play(uint8_t x, uint8_t y, const unsigned char *first, const unsigned char *second,
+                    uint8_t steps, uint8_t period, int8_t dx, int8_t dy);
+
+// Removes effect e
+void Effect_Kill(uint8_t e);
+
+// Effects playing, oldest first: Effect_First then Effect_Next until
+// EFFECT_NONE. e may be killed once its next one was read.
+uint8_t Effect_First(void);
+uint8_t Effect_Next(uint8_t e);
+
+// Position of effect e, its bottom left corner, and the sprite of its frame
+void Effect_Position(uint8_t e, uint8_t *x, uint8_t *y);
+const unsigned char *Effect_Sprite(uint8_t e);
+
+// Most effects playing at once since the game started
+uint8_t Effect_High(void);
+
+// =====================================================
+// ### ANIMATION ###
+
+// Ages every effect a tick, going to the next frame every period ticks and
+// removing the ones past their last frame or out of the screen
+void Effect_Update(void);
+
+#endif
@@ -0,0 +1,167 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "flow.h"
+#include "ramfunc.h"
+#include "profile.h"
+
+// =====================================================
+// Steps of a cell, the 8 neighbours. The field stores their index
+#define FLOW_STEPS      8
+#define FLOW_NONE       FLOW_STEPS      // target cell, or no way to it
+#define FLOW_UNSEEN     0xFF            // not reached by the search yet
+
+static const int8_t flow_dx[FLOW_STEPS] = { 0, 1, 1, 1, 0,-1,-1,-1};
+static const int8_t flow_dy[FLOW_STEPS] = {-1,-1, 0, 1, 1, 1, 0,-1};
+
+// Two fields: the followers read one while the search fills the other
+static uint8_t flow_field[2][FLOW_CELLS];
+static uint8_t flow_ready;                      // field the followers read
+static bool flow_valid;                         // flow_field[flow_ready] was searched
+
+static uint8_t flow_blocked[(FLOW_CELLS + 7) / 8];  // one bit for each cell
+static bool flow_changed;                       // obstacles changed since the search started
+
+// Search in progress, FIFO of cells
+static uint8_t flow_queue[FLOW_CELLS];
+static uint8_t flow_head, flow_tail;
+static uint8_t flow_target = FLOW_CELLS;        // cell searched from, FLOW_CELLS if none
+static uint8_t flow_wanted = FLOW_CELLS;        // cell of the target now
+static bool flow_searching;
+
+// =====================================================
+// ### OBSTACLES ###
+
+static bool Flow_IsBlocked(uint8_t cell){
+    return flow_blocked[cell >> 3] & (1 << (cell & 7));
+}
+
+// Forgets the field and the obstacles, for a new level
+void Flow_Reset(void){
+    Flow_Clear();
+    flow_valid = false;
+    flow_searching = false;
+    flow_target = FLOW_CELLS;
+    flow_wanted = FLOW_CELLS;
+}
+
+// Frees every cell, the field is kept until a new search ends
+void Flow_Clear(void){
+    uint8_t i;
+    for(i=0;i<sizeof(flow_blocked);i++){
+        flow_blocked[i] = 0;
+    }
+    flow_changed = true;
+}
+
+// Blocks the cells under a box, (x, y) being the bottom left corner
+void Flow_Block(uint8_t x, uint8_t y, uint8_t w, uint8_t h){
+    uint8_t i, j, cell;
+    int16_t top = y - h + 1;
+
+    if(top < 0) top = 0;
+    for(j=top/FLOW_CELL; j<=y/FLOW_CELL && j<FLOW_ROWS; j++){
+        for(i=x/FLOW_CELL; i<=(x+w-1)/FLOW_CELL && i<FLOW_COLUMNS; i++){
+            cell = j * FLOW_COLUMNS + i;
+            flow_blocked[cell >> 3] |= 1 << (cell & 7);
+        }
+    }
+    flow_changed = true;
+}
+
+// =====================================================
+// ### SEARCH ###
+
+// Starts a search from the cell of the target, if it isn't the cell the
+// field leads to already or the obstacles changed
+static void Flow_Start(void){
+    uint8_t *field = flow_field[!flow_ready];
+    uint8_t cell = flow_wanted;
+    uint8_t i;
+
+    if(cell>=FLOW_CELLS || (cell==flow_target && !flow_changed)) return;
+
+    flow_target = cell;
+    flow_changed = false;
+
+    for(i=0;i<FLOW_CELLS;i++){
+        field[i] = FLOW_UNSEEN;
+    }
+    field[cell] = FLOW_NONE;
+    flow_queue[0] = cell;
+    flow_head = 0;
+    flow_tail = 1;
+    flow_searching = true;
+}
+
+// Sets the point the field leads to
+// A search going on ends first, a target that moves meanwhile is searched from
+// right after, so the field keeps up with Link however often he changes cell.
+// Obstacles that changed start the search again at once.
+void Flow_Target(uint8_t x, uint8_t y){
+    flow_wanted = (y / FLOW_CELL) * FLOW_COLUMNS + x / FLOW_CELL;
+    if(!flow_searching || flow_changed) Flow_Start();
+}
+
+// Searches up to budget cells, the field is switched when the search ends and
+// the budget left goes to the search from where the target is now
+// A diagonal step is only taken if both straight steps around it are free
+RAMFUNC void Flow_Step(uint8_t budget){
+    uint8_t *field;
+    uint8_t cell, next, s;
+    int8_t i, j, ni, nj;
+
+    if(!flow_searching) return;
+
+    PROFILE_BEGIN();
+
+    while(flow_searching && budget){
+        // every reachable cell was searched
+        if(flow_head==flow_tail){
+            flow_ready = !flow_ready;
+            flow_valid = true;
+            flow_searching = false;
+            Flow_Start();
+            continue;
+        }
+
+        budget--;
+        field = flow_field[!flow_ready];
+        cell = flow_queue[flow_head++];
+        i = cell % FLOW_COLUMNS;
+        j = cell / FLOW_COLUMNS;
+
+        for(s=0;s<FLOW_STEPS;s++){
+            ni = i + flow_dx[s];
+            nj = j + flow_dy[s];
+            if(ni < 0 || ni >= FLOW_COLUMNS || nj < 0 || nj >= FLOW_ROWS) continue;
+
+            next = nj * FLOW_COLUMNS + ni;
+            if(field[next]!=FLOW_UNSEEN || Flow_IsBlocked(next)) continue;
+            if(flow_dx[s] && flow_dy[s] &&
+               (Flow_IsBlocked(j * FLOW_COLUMNS + ni) || Flow_IsBlocked(nj * FLOW_COLUMNS + i))) continue;
+
+            // the way back from next is the opposite step
+            field[next] = (s + FLOW_STEPS / 2) % FLOW_STEPS;
+            flow_queue[flow_tail++] = next;
+        }
+    }
+
+    PROFILE_END(PROFILE_FLOW);
+}
+
+// Gives the step, -1, 0 or 1 on each axis, from the cell of (x, y) towards the target
+// Returns 0 if there is none: the field isn't ready, the point is in the target
+// cell or it can't reach it
+bool Flow_Direction(uint8_t x, uint8_t y, int8_t *dx, int8_t *dy){
+    uint8_t step;
+
+    if(!flow_valid || x >= FLOW_COLUMNS * FLOW_CELL || y >= FLOW_ROWS * FLOW_CELL) return 0;
+
+    step = flow_field[flow_ready][(y / FLOW_CELL) * FLOW_COLUMNS + x / FLOW_CELL];
+    if(step >= FLOW_STEPS) return 0;
+
+    *dx = flow_dx[step];
+    *dy = flow_dy[step];
+    return 1;
+}
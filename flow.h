@@ -0,0 +1,51 @@
+#ifndef FLOW_H
+#define FLOW_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =====================================================
+// Flow field towards Link
+// The screen is split in cells of FLOW_CELL pixels. A breadth first search
+// from Link's cell gives every free cell the step that gets closer to him
+// around the blocked cells, so any number of followers read their way in O(1).
+// The search is spread over the level ticks, FLOW_BUDGET cells at a time. When
+// it ends, the next one starts from the cell Link is in by then, and obstacles
+// that change start it again at once.
+#define FLOW_CELL       4
+#define FLOW_COLUMNS    ((84 + FLOW_CELL - 1) / FLOW_CELL)
+#define FLOW_ROWS       ((48 + FLOW_CELL - 1) / FLOW_CELL)
+#define FLOW_CELLS      (FLOW_COLUMNS * FLOW_ROWS)
+
+// Cells searched in a level tick
+#define FLOW_BUDGET     64
+
+// =====================================================
+// ### OBSTACLES ###
+
+// Forgets the field and the obstacles, for a new level
+void Flow_Reset(void);
+
+// Frees every cell, the field is kept until a new search ends
+void Flow_Clear(void);
+
+// Blocks the cells under a box, (x, y) being the bottom left corner
+void Flow_Block(uint8_t x, uint8_t y, uint8_t w, uint8_t h);
+
+// =====================================================
+// ### SEARCH ###
+
+// Sets the point the field leads to
+// A search going on ends first, unless the obstacles changed
+void Flow_Target(uint8_t x, uint8_t y);
+
+// Searches up to budget cells, the field is switched when the search ends and
+// the next one starts if the target moved
+void Flow_Step(uint8_t budget);
+
+// Gives the step, -1, 0 or 1 on each axis, from the cell of (x, y) towards the target
+// Returns 0 if there is none: the field isn't ready, the point is in the target
+// cell or it can't reach it
+bool Flow_Direction(uint8_t x, uint8_t y, int8_t *dx, int8_t *dy);
+
+#endif
@@ -0,0 +1,103 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "game.h"
+#include "actions.h"
+#include "clock.h"
+
+// =====================================================
+// State description
+typedef struct{
+    void (*enter)(uint8_t from);        // called when the state begins
+    uint8_t (*update)(void);            // one step of the state, returns the next state
+    void (*exit)(uint8_t to);           // called when the state ends
+    uint16_t period;                    // milliseconds between updates
+    uint8_t clock;                      // run mode while in the state
+} State_t;
+
+// One row per state, in the STATE_ order
+static const State_t game_states[STATES] = {
+    {InstructionScreen_Enter, InstructionScreen_Update, InstructionScreen_Exit, 430, CLOCK_IDLE},  // STATE_INSTRUCTIONS
+    {TitleScreen_Enter,       TitleScreen_Update,       TitleScreen_Exit,       200, CLOCK_IDLE},  // STATE_TITLE
+    {SelectionScreen_Enter,   SelectionScreen_Update,   SelectionScreen_Exit,    20, CLOCK_IDLE},  // STATE_MENU
+    {StoryScreen_Enter,       StoryScreen_Update,       StoryScreen_Exit,        20, CLOCK_IDLE},  // STATE_STORY
+    {HighScoreScreen_Enter,   HighScoreScreen_Update,   HighScoreScreen_Exit,    20, CLOCK_IDLE},  // STATE_HIGHSCORE
+    {NewGame_Enter,           NewGame_Update,           NewGame_Exit,            20, CLOCK_RUN},   // STATE_CAMPAIGN
+    {SurvivorMode_Enter,      SurvivorMode_Update,      SurvivorMode_Exit,       20, CLOCK_RUN},   // STATE_SURVIVOR
+    {Level_Enter,             Level_Update,             Level_Exit,              75, CLOCK_RUN},   // STATE_LEVEL
+    {Pause_Enter,             Pause_Update,             Pause_Exit,              20, CLOCK_IDLE},  // STATE_PAUSE
+    {GameOver_Enter,          GameOver_Update,          GameOver_Exit,           20, CLOCK_RUN},   // STATE_GAMEOVER
+};
+
+static uint8_t game_state;              // current state
+static uint32_t game_last;              // time of the last update
+static uint16_t game_wait;              // time from the last update to the next one
+
+static void (*game_background[GAME_BACKGROUND_MAX])(void);
+static uint8_t game_background_n = 0;
+
+// =====================================================
+// ### SCHEDULER ###
+
+// Runs the game from the given state. Never returns
+// The first state is entered as if coming from itself
+void Game_Run(uint8_t first){
+    uint8_t next, i;
+
+    game_state = first;
+    game_last = Clock_Millis();
+    game_wait = game_states[first].period;
+    Clock_SetMode(game_states[first].clock);
+    game_states[first].enter(first);
+
+    while(1){
+        // time for the next update of the current state
+        if(Clock_Millis() - game_last >= game_wait){
+            game_last = Clock_Millis();
+            game_wait = game_states[game_state].period;
+
+            next = game_states[game_state].update();
+
+            if(next != game_state){
+                uint8_t from = game_state;
+                game_states[from].exit(next);
+
+                game_state = next;
+                game_wait = game_states[next].period;
+                Clock_SetMode(game_states[next].clock);
+                game_states[next].enter(from);
+            }
+        }
+
+        // background work between updates
+        for(i=0;i<game_background_n;i++){
+            game_background[i]();
+        }
+
+        // RTOS builds sleep until the next update, the render task runs meanwhile
+        #ifdef RTOS
+        if(Clock_Millis() - game_last < game_wait){
+            Clock_DelayMs(game_wait - (Clock_Millis() - game_last));
+        }
+        #endif
+    }
+}
+
+// Delays the next update of the current state by ms milliseconds
+// instead of the state period. Valid for the next update only
+void Game_Wait(uint16_t ms){
+    game_wait = ms;
+}
+
+// Returns the current state
+uint8_t Game_GetState(){
+    return game_state;
+}
+
+// Adds a job to be run between state updates (audio, telemetry, autosave...)
+// Returns 0 if there's no room for it
+bool Game_AddBackground(void (*job)(void)){
+    if(game_background_n >= GAME_BACKGROUND_MAX) return 0;
+    game_background[game_background_n++] = job;
+    return 1;
+}
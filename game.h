@@ -0,0 +1,45 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include "definitions.h"
+
+// =====================================================
+// Game states
+// Every screen is a state with enter, update and exit handlers.
+// The scheduler in Game_Run calls them, so no screen owns a loop
+// and the stack depth doesn't grow with the game flow.
+
+#define STATE_INSTRUCTIONS  0   // button instructions, shown at boot
+#define STATE_TITLE         1   // title screen animation
+#define STATE_MENU          2   // selection menu
+#define STATE_STORY         3   // story screen
+#define STATE_HIGHSCORE     4   // top 3 survivor scores
+#define STATE_CAMPAIGN      5   // story mode levels and cutscenes
+#define STATE_SURVIVOR      6   // survivor mode waves
+#define STATE_LEVEL         7   // a level being played
+#define STATE_PAUSE         8   // pause menu over a level
+#define STATE_GAMEOVER      9   // game over animation
+
+#define STATES              10
+
+// Background jobs run between state updates
+#define GAME_BACKGROUND_MAX 4
+
+// =====================================================
+// ### SCHEDULER ###
+
+// Runs the game from the given state. Never returns
+void Game_Run(uint8_t first);
+
+// Delays the next update of the current state by ms milliseconds
+// instead of the state period. Valid for the next update only
+void Game_Wait(uint16_t ms);
+
+// Returns the current state
+uint8_t Game_GetState();
+
+// Adds a job to be run between state updates (audio, telemetry, autosave...)
+// Returns 0 if there's no room for it
+bool Game_AddBackground(void (*job)(void));
+
+#endif
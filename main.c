@@ -1,8 +1,13 @@
-#include "actions.h"
-
-int main(void)
-{
-    Setup();
-    TitleScreen();
-}
-
+#include "actions.h"
+#include "game.h"
+#include "rtos.h"
+
+int main(void)
+{
+#ifdef RTOS
+    Rtos_Run(STATE_INSTRUCTIONS);
+#else
+    Setup();
+    Game_Run(STATE_INSTRUCTIONS);
+#endif
+}
@@ -0,0 +1,27 @@
+#ifndef PATHS_H
+#define PATHS_H
+
+// =====================================================
+// Trajectory tables of BEHAVIOR_PATH, generated by paths.py. Don't edit.
+// One byte a step: x in the high nibble, y in the low one, both signed.
+
+#include <stdint.h>
+
+#include "behavior.h"
+
+const uint8_t path_step[PATHS][PATH_STEPS] = {
+    // PATH_CIRCLE
+    {0x20, 0x11, 0x10, 0x21, 0x12, 0x01, 0x11, 0x02, 0x02, 0xF1, 0x01, 0xF2, 0xE1, 0xF0, 0xF1, 0xE0,
+     0xE0, 0xFF, 0xF0, 0xEF, 0xFE, 0x0F, 0xFF, 0x0E, 0x0E, 0x1F, 0x0F, 0x1E, 0x2F, 0x10, 0x1F, 0x20},
+    // PATH_EIGHT
+    {0x22, 0x32, 0x22, 0x10, 0x20, 0x1E, 0x1E, 0x0E, 0x0E, 0xFE, 0xFE, 0xE0, 0xF0, 0xE2, 0xD2, 0xE2,
+     0xE2, 0xD2, 0xE2, 0xF0, 0xE0, 0xFE, 0xFE, 0x0E, 0x0E, 0x1E, 0x1E, 0x20, 0x10, 0x22, 0x32, 0x22},
+    // PATH_DIVE
+    {0x03, 0x03, 0x03, 0x02, 0x02, 0x02, 0x01, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x00, 0x00, 0x0F, 0x00,
+     0x0F, 0x00, 0x0F, 0x0F, 0x00, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F},
+    // PATH_ZIGZAG
+    {0x23, 0x13, 0x1D, 0x2D, 0x23, 0x13, 0x1D, 0x2D, 0x23, 0x13, 0x1D, 0x2D, 0x23, 0x13, 0x1D, 0x2D,
+     0xE3, 0xF3, 0xFD, 0xED, 0xE3, 0xF3, 0xFD, 0xED, 0xE3, 0xF3, 0xFD, 0xED, 0xE3, 0xF3, 0xFD, 0xED},
+};
+
+#endif
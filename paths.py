@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+# Generates paths.h, the trajectory tables of the behavior programs:
+#   python3 paths.py > paths.h
+#
+# Each path is a closed curve sampled at PATH_STEPS points. The points are
+# rounded to whole pixels and the table keeps the step between two points,
+# so an enemy that walks the whole table ends where it started.
+
+import math
+
+PATH_STEPS = 32
+
+def circle(t):
+    a = 2 * math.pi * t
+    return 8 * math.sin(a), 8 - 8 * math.cos(a)
+
+def eight(t):
+    a = 2 * math.pi * t
+    return 12 * math.sin(a), 6 * math.sin(2 * a)
+
+# a fast drop and a slow climb back
+def dive(t):
+    if t < 0.25:
+        return 0, 16 * math.sin(2 * math.pi * t)
+    return 0, 16 * math.cos(2 * math.pi * (t - 0.25) / 3)
+
+# right in four teeth, then back
+def zigzag(t):
+    x = 24 * (1 - abs(1 - 2 * t))
+    tooth = (t * 8) % 1
+    return x, 3 * (1 - abs(1 - 2 * tooth)) * 2 - 3
+
+PATHS = [
+    ("PATH_CIRCLE", circle),
+    ("PATH_EIGHT", eight),
+    ("PATH_DIVE", dive),
+    ("PATH_ZIGZAG", zigzag),
+]
+
+def nibble(v):
+    assert -8 <= v <= 7, v
+    return v & 0x0F
+
+def steps(curve):
+    points = [curve(i / PATH_STEPS) for i in range(PATH_STEPS + 1)]
+    points = [(round(x), round(y)) for x, y in points]
+    return [(nibble(x1 - x0) << 4) | nibble(y1 - y0)
+            for (x0, y0), (x1, y1) in zip(points, points[1:])]
+
+print("#ifndef PATHS_H")
+print("#define PATHS_H")
+print()
+print("// =====================================================")
+print("// Trajectory tables of BEHAVIOR_PATH, generated by paths.py. Don't edit.")
+print("// One byte a step: x in the high nibble, y in the low one, both signed.")
+print()
+print("#include <stdint.h>")
+print()
+print("#include \"behavior.h\"")
+print()
+print("const uint8_t path_step[PATHS][PATH_STEPS] = {")
+for name, curve in PATHS:
+    table = steps(curve)
+    print("    // %s" % name)
+    for i in range(0, PATH_STEPS, 16):
+        print("    " + ("{" if i == 0 else " ") +
+              ", ".join("0x%02X" % b for b in table[i:i + 16]) +
+              ("}," if i + 16 >= PATH_STEPS else ","))
+print("};")
+print()
+print("#endif")
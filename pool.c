@@ -0,0 +1,60 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pool.h"
+
+// =====================================================
+// ### SLOTS ###
+
+// Sets a pool of size slots over the owner's chain arrays, with every slot free
+void Pool_Init(Pool_t *pool, uint8_t *next, uint8_t *prev, uint8_t size){
+    pool->next = next;
+    pool->prev = prev;
+    pool->size = size;
+    pool->first = POOL_NONE;
+    pool->last = POOL_NONE;
+    pool->free = POOL_NONE;
+    pool->fresh = 0;
+    pool->count = 0;
+}
+
+// Takes a free slot and puts it at the end of the live ones
+// Returns POOL_NONE if the pool is full
+uint8_t Pool_Take(Pool_t *pool){
+    uint8_t slot;
+
+    if(pool->free!=POOL_NONE){
+        slot = pool->free;
+        pool->free = pool->next[slot];
+    }else if(pool->fresh<pool->size){
+        slot = pool->fresh++;
+    }else{
+        return POOL_NONE;
+    }
+
+    pool->next[slot] = POOL_NONE;
+    pool->prev[slot] = pool->last;
+    if(pool->last!=POOL_NONE) pool->next[pool->last] = slot;
+    else pool->first = slot;
+    pool->last = slot;
+
+    pool->count++;
+    if(pool->count > pool->high) pool->high = pool->count;
+    return slot;
+}
+
+// Gives a live slot back, the other live slots keep their order
+void Pool_Give(Pool_t *pool, uint8_t slot){
+    uint8_t next = pool->next[slot];
+    uint8_t prev = pool->prev[slot];
+
+    if(prev!=POOL_NONE) pool->next[prev] = next;
+    else pool->first = next;
+    if(next!=POOL_NONE) pool->prev[next] = prev;
+    else pool->last = prev;
+
+    pool->next[slot] = pool->free;
+    pool->free = slot;
+    pool->count--;
+}
+
@@ -0,0 +1,48 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =====================================================
+// Fixed-size pools
+// A pool hands out the slots of arrays kept by its owner, such as the
+// fields of Enemies_t. The free slots are chained through next[], and so
+// are the live ones, oldest first, with prev[] to unlink them; both
+// arrays belong to the owner too. Taking and giving back a slot are O(1).
+// The slots never handed out since Pool_Init are free without being
+// chained, so emptying a pool is O(1) as well.
+// high is the most slots live at once since the game started, to size
+// the pools: it survives Pool_Init.
+#define POOL_NONE       0xFF    // no slot, end of a chain
+
+typedef struct{
+    uint8_t *next;                      // next live slot, or next free slot
+    uint8_t *prev;                      // previous live slot
+    uint8_t size;                       // slots of the pool, up to 255
+    uint8_t first;                      // oldest live slot
+    uint8_t last;                       // newest live slot
+    uint8_t free;                       // a free slot handed out before
+    uint8_t fresh;                      // slots from here on were never handed out
+    uint8_t count;                      // live slots
+    uint8_t high;                       // most live slots at once
+} Pool_t;
+
+// =====================================================
+// ### SLOTS ###
+
+// Sets a pool of size slots over the owner's chain arrays, with every slot free
+void Pool_Init(Pool_t *pool, uint8_t *next, uint8_t *prev, uint8_t size);
+
+// Takes a free slot and puts it at the end of the live ones
+// Returns POOL_NONE if the pool is full
+uint8_t Pool_Take(Pool_t *pool);
+
+// Gives a live slot back, the other live slots keep their order
+void Pool_Give(Pool_t *pool, uint8_t slot);
+
+// The live slots, oldest first, are pool->first then pool->next[slot]
+// until POOL_NONE. A slot may be given back while it is visited if its
+// next slot was read before.
+
+#endif
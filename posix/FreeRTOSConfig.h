@@ -0,0 +1,59 @@
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+// =====================================================
+// FreeRTOS configuration for the RTOS build on Linux
+// (portable/ThirdParty/GCC/Posix). Same tasks and rates as the TM4C one.
+
+#include <stdint.h>
+#include <limits.h>
+
+#include "clock.h"
+#include "rtos.h"
+#include "port.h"
+
+#define configUSE_PREEMPTION                    1
+#define configUSE_TIME_SLICING                  0
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+#define configUSE_IDLE_HOOK                     0
+#define configUSE_TICK_HOOK                     0
+#define configUSE_16_BIT_TICKS                  0
+
+#define configCPU_CLOCK_HZ                      ((unsigned long)80000000)
+#define configTICK_RATE_HZ                      ((TickType_t)CLOCK_TICK_HZ)
+
+#define configMAX_PRIORITIES                    4
+#define configMINIMAL_STACK_SIZE                ((uint16_t)PTHREAD_STACK_MIN)
+#define configMAX_TASK_NAME_LEN                 8
+#define configSUPPORT_DYNAMIC_ALLOCATION        1
+#define configSUPPORT_STATIC_ALLOCATION         0
+#define configTOTAL_HEAP_SIZE                   ((size_t)(64 * 1024))
+
+#define configUSE_MUTEXES                       1
+#define configUSE_RECURSIVE_MUTEXES             1
+#define configUSE_COUNTING_SEMAPHORES           0
+#define configUSE_TIMERS                        0
+#define configUSE_CO_ROUTINES                   0
+#define configQUEUE_REGISTRY_SIZE               0
+
+#define configCHECK_FOR_STACK_OVERFLOW          0
+#define configUSE_MALLOC_FAILED_HOOK            1
+
+// Per task CPU usage (Rtos_Show and the report on exit), in microseconds
+#define configGENERATE_RUN_TIME_STATS           1
+#define configUSE_TRACE_FACILITY                1
+#define configRUN_TIME_COUNTER_TYPE             uint64_t
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()        Port_RunTime()
+
+#define INCLUDE_vTaskDelay                      1
+#define INCLUDE_xTaskDelayUntil                 1
+#define INCLUDE_xTaskGetCurrentTaskHandle       1
+#define INCLUDE_xSemaphoreGetMutexHolder        1
+#define INCLUDE_vTaskSuspend                    0
+#define INCLUDE_vTaskDelete                     0
+
+#define configASSERT(x)                         if(!(x)){ vAssertCalled(__FILE__, __LINE__); }
+void vAssertCalled(const char *file, unsigned long line);
+
+#endif
@@ -0,0 +1 @@
+#include "tiva.h"
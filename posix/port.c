@@ -0,0 +1,280 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <termios.h>
+
+#include "tiva.h"
+#include "port.h"
+#include "rtos.h"
+#include "buttons.h"
+
+// =====================================================
+// POSIX port of the hardware used by the game
+//  display  the Nokia 5110 (PCD8544) is emulated behind the SSI0 registers
+//           and drawn on the terminal, two pixel rows per text line
+//  keypad   arrows or WASD move, space or K attacks, P or Enter pauses
+//  clock    the system clock calls do nothing, the tick comes from FreeRTOS
+// Q quits and prints the CPU usage of each task.
+
+// Registers with a meaning here
+#define PORT_DC                 0x40004100
+#define PORT_SSI0_DR            0x40008008
+#define PORT_SSI0_SR            0x4000800C
+#define PORT_SSI_SR_TNF         0x00000002
+#define PORT_DR_EMPTY           0xFFFFFFFF
+
+// The other registers are only stored
+#define PORT_REGS               64
+
+// A key is held this long after the terminal sends it, the first time
+// long enough to reach the terminal autorepeat
+#define PORT_KEY_FIRST_MS       500
+#define PORT_KEY_REPEAT_MS      100
+
+static uint32_t port_dc;                    // DC pin, command or data
+static uint32_t port_dr = PORT_DR_EMPTY;    // byte written to SSI0_DR, not handled yet
+static uint32_t port_sr;                    // SSI0_SR, never busy
+static uint32_t port_addr[PORT_REGS];
+static uint32_t port_value[PORT_REGS];
+
+// PCD8544 state
+static uint8_t port_ram[84 * 6];            // display RAM, bank-major like Screen
+static uint8_t port_x, port_y;              // address counters
+static bool port_extended;                  // H bit, extended instruction set
+static bool port_dirty;                     // RAM changed since the terminal was drawn
+
+// Keypad state
+static int8_t port_row = -1;                // keypad row being driven
+static uint8_t port_key = BUTTON_NOT_PRESSED;
+static uint64_t port_key_until;             // time the key is released, in us
+
+static bool port_started;
+static struct termios port_termios;         // terminal mode to restore
+
+// =====================================================
+// ### DISPLAY ###
+
+// Handles a byte sent to the PCD8544
+static void port_lcd(uint8_t byte, bool data){
+    if(data){
+        port_ram[port_y * 84 + port_x] = byte;
+        port_dirty = true;
+        if(++port_x == 84){
+            port_x = 0;
+            port_y = (port_y + 1) % 6;
+        }
+        return;
+    }
+
+    // function set, the other extended commands are ignored
+    if((byte & 0xF8) == 0x20){
+        port_extended = byte & 0x01;
+        return;
+    }
+    if(port_extended) return;
+
+    if(byte & 0x80)                 port_x = (byte & 0x7F) % 84;
+    else if((byte & 0xF8) == 0x40)  port_y = (byte & 0x07) % 6;
+}
+
+// The SSI0_DR write of the last register access is handled on the next one
+static void port_flush(void){
+    if(port_dr == PORT_DR_EMPTY) return;
+    port_lcd((uint8_t)port_dr, port_dc != 0);
+    port_dr = PORT_DR_EMPTY;
+}
+
+// Draws the display RAM, upper half block for even rows and lower for odd ones
+static void port_draw(void){
+    static const char *blocks[4] = {" ", "▀", "▄", "█"};
+    uint8_t x, y, top, bottom;
+
+    port_flush();
+    if(!port_dirty) return;
+    port_dirty = false;
+
+    printf("\x1b[H");
+    for(y=0;y<48;y+=2){
+        for(x=0;x<84;x++){
+            top = (port_ram[(y >> 3) * 84 + x] >> (y & 7)) & 1;
+            bottom = (port_ram[((y + 1) >> 3) * 84 + x] >> ((y + 1) & 7)) & 1;
+            fputs(blocks[top | (bottom << 1)], stdout);
+        }
+        fputs("\r\n", stdout);
+    }
+    fflush(stdout);
+}
+
+volatile uint32_t *Port_Reg(uint32_t addr){
+    uint8_t i;
+
+    port_flush();
+
+    switch(addr){
+        case PORT_DC:       return &port_dc;
+        case PORT_SSI0_DR:  return &port_dr;
+        case PORT_SSI0_SR:  port_sr = PORT_SSI_SR_TNF; return &port_sr;
+    }
+
+    for(i=0;i<PORT_REGS-1 && port_addr[i] && port_addr[i]!=addr;i++){}
+    port_addr[i] = addr;
+    return &port_value[i];
+}
+
+// =====================================================
+// ### TERMINAL ###
+
+static void port_stop(void){
+    tcsetattr(STDIN_FILENO, TCSANOW, &port_termios);
+    printf("\x1b[?25h\r\n");
+    fflush(stdout);
+}
+
+// Raw, non blocking input and a clean screen without cursor
+static void port_start(void){
+    struct termios raw;
+
+    port_started = true;
+    tcgetattr(STDIN_FILENO, &port_termios);
+    raw = port_termios;
+    raw.c_lflag &= ~(ICANON | ECHO | ISIG);
+    raw.c_cc[VMIN] = 0;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+    atexit(port_stop);
+
+    printf("\x1b[2J\x1b[?25l");
+    port_dirty = true;
+}
+
+// Prints the CPU usage of each task and leaves
+static void port_quit(void){
+    Rtos_Usage_t usage[RTOS_TASKS];
+    uint8_t n, i;
+
+    n = Rtos_Usage(usage, RTOS_TASKS);
+    port_stop();
+
+    printf("task      cpu %%\n");
+    for(i=0;i<n;i++){
+        printf("%-8s %3u.%u\n", usage[i].name, usage[i].permille / 10, usage[i].permille % 10);
+    }
+    exit(0);
+}
+
+// Keypad code of a terminal key
+static uint8_t port_keycode(char c){
+    switch(c){
+        case 'A': case 'w': return 12;      // UP
+        case 'C': case 'd': return 23;      // RIGHT
+        case 'B': case 's': return 32;      // DOWN
+        case 'D': case 'a': return 21;      // LEFT
+        case ' ': case 'k': return 44;      // SWORD
+        case '\n': case 'p': return 14;     // PAUSE
+    }
+    return BUTTON_NOT_PRESSED;
+}
+
+// Reads the keys sent by the terminal and draws the display
+// Called at the start of every keypad scan
+static void port_poll(void){
+    char c;
+    uint8_t key;
+    uint64_t now;
+
+    if(!port_started) port_start();
+
+    now = Port_RunTime();
+    while(read(STDIN_FILENO, &c, 1) == 1){
+        if(c == 'q' || c == 0x03) port_quit();
+
+        // escape sequences only matter for the arrows, ESC [ A
+        if(c == 0x1b || c == '[') continue;
+
+        key = port_keycode(c);
+        if(key == BUTTON_NOT_PRESSED) continue;
+
+        if(key == port_key && now < port_key_until) port_key_until = now + PORT_KEY_REPEAT_MS * 1000;
+        else port_key_until = now + PORT_KEY_FIRST_MS * 1000;
+        port_key = key;
+    }
+    if(now >= port_key_until) port_key = BUTTON_NOT_PRESSED;
+
+    port_draw();
+}
+
+// =====================================================
+// ### DRIVERLIB ###
+
+void GPIOPinTypeGPIOInput(uint32_t port, uint8_t pins){}
+void GPIOPinTypeGPIOOutput(uint32_t port, uint8_t pins){}
+void GPIOPadConfigSet(uint32_t port, uint8_t pins, uint32_t strength, uint32_t type){}
+
+// Rows are driven through PF4, PB0, PB1 and PB5
+void GPIOPinWrite(uint32_t port, uint8_t pins, uint8_t value){
+    if(!value){
+        port_row = -1;
+        return;
+    }
+
+    if(port == GPIO_PORTF_BASE && pins == GPIO_PIN_4){
+        port_row = 0;
+        port_poll();
+    }
+    if(port == GPIO_PORTB_BASE && pins == GPIO_PIN_0) port_row = 1;
+    if(port == GPIO_PORTB_BASE && pins == GPIO_PIN_1) port_row = 2;
+    if(port == GPIO_PORTB_BASE && pins == GPIO_PIN_5) port_row = 3;
+}
+
+// Columns are read through PF0 to PF3
+int32_t GPIOPinRead(uint32_t port, uint8_t pins){
+    uint8_t row, column;
+
+    if(port_key == BUTTON_NOT_PRESSED || port_row < 0) return 0;
+
+    row = port_key / 10 - 1;
+    column = port_key % 10 - 1;
+    if(row != port_row || pins != (1 << column)) return 0;
+    return pins;
+}
+
+void SysCtlClockSet(uint32_t config){}
+void SysCtlPeripheralEnable(uint32_t peripheral){}
+
+void SysTickEnable(void){}
+void SysTickIntEnable(void){}
+void SysTickPeriodSet(uint32_t period){}
+
+// Only used as a random seed
+uint32_t SysTickValueGet(void){
+    return (uint32_t)Port_RunTime() & 0x00FFFFFF;
+}
+
+bool IntMasterEnable(void){
+    return false;
+}
+
+// =====================================================
+// ### FREERTOS ###
+
+// Microseconds since the first call
+uint64_t Port_RunTime(void){
+    static uint64_t start = 0;
+    struct timespec now;
+    uint64_t us;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    us = (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+    if(!start) start = us;
+    return us - start;
+}
+
+void vAssertCalled(const char *file, unsigned long line){
+    if(port_started) port_stop();
+    fprintf(stderr, "assert failed: %s:%lu\n", file, line);
+    abort();
+}
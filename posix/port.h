@@ -0,0 +1,19 @@
+#ifndef PORT_H
+#define PORT_H
+
+// =====================================================
+// Included before every source of the POSIX build (-include posix/port.h).
+// The register accesses of the display and keypad drivers go to port.c,
+// which emulates the Nokia 5110 on the terminal.
+
+#include <stdint.h>
+
+volatile uint32_t *Port_Reg(uint32_t addr);
+
+#define LCD_REG(addr)           (*Port_Reg(addr))
+#define WRITE_REG(addr)         (*Port_Reg(addr))
+
+// Run time counter of the task statistics, in microseconds
+uint64_t Port_RunTime(void);
+
+#endif
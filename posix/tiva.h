@@ -0,0 +1,57 @@
+#ifndef TIVA_H
+#define TIVA_H
+
+// =====================================================
+// The part of TivaWare used by the game, for the POSIX port.
+// inc/ and driverlib/ only include this file; port.c implements it.
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// inc/hw_memmap.h
+#define GPIO_PORTB_BASE         0x40005000
+#define GPIO_PORTF_BASE         0x40025000
+
+// inc/hw_gpio.h
+#define GPIO_O_LOCK             0x00000520
+#define GPIO_O_CR               0x00000524
+#define GPIO_LOCK_KEY           0x4C4F434B
+
+// driverlib/gpio.h
+#define GPIO_PIN_0              0x00000001
+#define GPIO_PIN_1              0x00000002
+#define GPIO_PIN_2              0x00000004
+#define GPIO_PIN_3              0x00000008
+#define GPIO_PIN_4              0x00000010
+#define GPIO_PIN_5              0x00000020
+#define GPIO_STRENGTH_2MA       0x00000001
+#define GPIO_PIN_TYPE_STD_WPD   0x0000000C
+
+void GPIOPinTypeGPIOInput(uint32_t port, uint8_t pins);
+void GPIOPinTypeGPIOOutput(uint32_t port, uint8_t pins);
+void GPIOPadConfigSet(uint32_t port, uint8_t pins, uint32_t strength, uint32_t type);
+int32_t GPIOPinRead(uint32_t port, uint8_t pins);
+void GPIOPinWrite(uint32_t port, uint8_t pins, uint8_t value);
+
+// driverlib/sysctl.h
+#define SYSCTL_SYSDIV_2_5       0xC1000000
+#define SYSCTL_SYSDIV_16        0x07800000
+#define SYSCTL_USE_PLL          0x00000000
+#define SYSCTL_XTAL_16MHZ       0x00000540
+#define SYSCTL_OSC_MAIN         0x00000000
+#define SYSCTL_PERIPH_GPIOB     0xF0000801
+#define SYSCTL_PERIPH_GPIOF     0xF0000805
+
+void SysCtlClockSet(uint32_t config);
+void SysCtlPeripheralEnable(uint32_t peripheral);
+
+// driverlib/systick.h
+void SysTickEnable(void);
+void SysTickIntEnable(void);
+void SysTickPeriodSet(uint32_t period);
+uint32_t SysTickValueGet(void);
+
+// driverlib/interrupt.h
+bool IntMasterEnable(void);
+
+#endif
@@ -0,0 +1,65 @@
+#include "profile.h"
+
+#ifdef PROFILE
+
+#include "Nokia5110.h"
+
+// Section names, 4 characters each to fit the display
+static const char *profile_names[PROFILE_SECTIONS] = {
+    "PBMP", "CBMP", "DBUF", "COLL", "FLOW", "BHVR", "SWRM", "PROJ",
+};
+
+Profile_t profile_table[PROFILE_SECTIONS];
+
+// Size of the code copied to SRAM, defined in tm4c123gh6pm.cmd
+extern uint8_t __ramfunc_size;
+
+// Enables the cycle counter and clears the measures
+void Profile_Init(void){
+    // the counter isn't cleared, RTOS builds count the task run time with it
+    CORE_DEMCR_R |= CORE_DEMCR_TRCENA;
+    DWT_CTRL_R |= DWT_CTRL_CYCCNTENA;
+    Profile_Reset();
+}
+
+// Clears the measures
+void Profile_Reset(void){
+    uint8_t i;
+    for(i=0;i<PROFILE_SECTIONS;i++){
+        profile_table[i].calls = 0;
+        profile_table[i].cycles = 0;
+        profile_table[i].max = 0;
+    }
+}
+
+// Adds a measure to a section
+void Profile_Add(uint8_t section, uint32_t cycles){
+    profile_table[section].calls++;
+    profile_table[section].cycles += cycles;
+    if(cycles > profile_table[section].max) profile_table[section].max = cycles;
+}
+
+// Shows the SRAM code size and the average cycles per call of the sections
+// starting at first, straight on the display
+//  RAM    nnnnn
+//  PBMP   nnnnn
+void Profile_Show(uint8_t first){
+    uint8_t i, row;
+
+    Nokia5110_Clear();
+    Nokia5110_OutString("RAM  ");
+    Nokia5110_OutUDec((uint16_t)(uint32_t)&__ramfunc_size);
+
+    for(i=first, row=1; i<PROFILE_SECTIONS && row<6; i++, row++){
+        uint32_t average = 0;
+        if(profile_table[i].calls) average = profile_table[i].cycles / profile_table[i].calls;
+        if(average > 65535) average = 65535;
+
+        Nokia5110_SetCursor(0, row);
+        Nokia5110_OutString((char *)profile_names[i]);
+        Nokia5110_OutChar(' ');
+        Nokia5110_OutUDec(average);
+    }
+}
+
+#endif
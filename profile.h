@@ -0,0 +1,72 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =====================================================
+// Build with PROFILE defined to measure the hot code with the DWT cycle
+// counter. The results are kept in profile_table, which can be read from the
+// debugger, and are shown on the display by Profile_Show.
+// Build with PROFILE and NO_RAMFUNC to get the flash numbers for comparison.
+
+// Profiled sections
+enum profileSection
+{
+    PROFILE_PRINTBMP,                   // Nokia5110_PrintBMP, Nokia5110_OrBMP
+    PROFILE_CLEARBITMAP,                // Nokia5110_ClearBitmap
+    PROFILE_DISPLAYBUFFER,              // Nokia5110_DisplayBuffer (lcddatawrite loop)
+    PROFILE_COLLISION,                  // Collision_Check, Collision_Query
+    PROFILE_FLOW,                       // Flow_Step
+    PROFILE_BEHAVIOR,                   // Behavior_Run
+    PROFILE_SWARM,                      // Swarm_Update
+    PROFILE_PROJECTILE,                 // Projectile_Update
+    PROFILE_SECTIONS
+};
+
+// Accumulated measures of a section
+typedef struct{
+    uint32_t calls;                     // how many times the section ran
+    uint32_t cycles;                    // total core cycles spent
+    uint32_t max;                       // worst case in a single call
+} Profile_t;
+
+// Cycle counter, also used for the RTOS task statistics
+#define DWT_CTRL_R              (*((volatile uint32_t *)0xE0001000))
+#define DWT_CYCCNT_R            (*((volatile uint32_t *)0xE0001004))
+#define DWT_CTRL_CYCCNTENA      0x00000001  // Enable cycle counter
+#define CORE_DEMCR_R            (*((volatile uint32_t *)0xE000EDFC))
+#define CORE_DEMCR_TRCENA       0x01000000  // Enable DWT
+
+#ifdef PROFILE
+
+// Opens and closes a measure inside a function
+#define PROFILE_BEGIN()         uint32_t profile_start = DWT_CYCCNT_R
+#define PROFILE_END(section)    Profile_Add((section), DWT_CYCCNT_R - profile_start)
+
+extern Profile_t profile_table[PROFILE_SECTIONS];
+
+// Enables the cycle counter and clears the measures
+void Profile_Init(void);
+
+// Clears the measures
+void Profile_Reset(void);
+
+// Adds a measure to a section
+void Profile_Add(uint8_t section, uint32_t cycles);
+
+// Shows the SRAM code size and the average cycles per call of the sections
+// starting at first, straight on the display
+void Profile_Show(uint8_t first);
+
+#else
+
+#define PROFILE_BEGIN()
+#define PROFILE_END(section)
+#define Profile_Init()
+#define Profile_Reset()
+#define Profile_Show(first)
+
+#endif
+
+#endif
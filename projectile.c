@@ -0,0 +1,138 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "projectile.h"
+#include "arena.h"
+#include "pool.h"
+#include "ramfunc.h"
+#include "profile.h"
+#include "Nokia5110.h"
+
+// =====================================================
+// Fields of the projectiles of a level, taken from the level arena
+typedef struct{
+    const unsigned char *sprite[PROJECTILES];   // what is drawn
+    int16_t x[PROJECTILES];             // bottom left corner, 1/16 pixels
+    int16_t y[PROJECTILES];
+    int8_t vx[PROJECTILES];             // speed, 1/16 pixels a tick
+    int8_t vy[PROJECTILES];
+    uint8_t life[PROJECTILES];          // ticks left
+    uint8_t owner[PROJECTILES];         // PROJECTILE_LINK or PROJECTILE_ENEMY
+    uint8_t next[PROJECTILES];          // chains of the pool
+    uint8_t prev[PROJECTILES];
+} Projectiles_t;
+
+static Projectiles_t *projectile;       // NULL if the arena had no room
+static Pool_t projectile_pool;
+
+// Returns 1 if sprite at (x, y), in 1/16 pixels, is whole on the screen
+static bool Projectile_Inside(const unsigned char *sprite, int16_t x, int16_t y){
+    int16_t w = Nokia5110_getWidth(sprite) << PROJECTILE_SHIFT;
+    int16_t h = Nokia5110_getHeight(sprite) << PROJECTILE_SHIFT;
+
+    return x >= 0 && x + w <= (84 << PROJECTILE_SHIFT) &&
+           y >= h - (1 << PROJECTILE_SHIFT) && y < (48 << PROJECTILE_SHIFT);
+}
+
+// =====================================================
+// ### PROJECTILES ###
+
+// Takes the projectiles of a new level from the level arena, with none flying
+// Call it after Arena_Reset
+void Projectile_Reset(void){
+    projectile = Arena_Alloc(sizeof(Projectiles_t));
+    if(projectile) Pool_Init(&projectile_pool, projectile->next, projectile->prev, PROJECTILES);
+}
+
+// Fires sprite from (x, y), its bottom left corner, at (vx, vy) 1/16 pixels
+// a tick for life ticks
+// Returns the projectile, PROJECTILE_NONE if there is no room or it starts
+// out of the screen
+uint8_t Projectile_Fire(uint8_t owner, const unsigned char *sprite, uint8_t x, uint8_t y, int8_t vx, int8_t vy, uint8_t life){
+    uint8_t p;
+
+    if(!projectile || !life) return PROJECTILE_NONE;
+    if(!Projectile_Inside(sprite, x << PROJECTILE_SHIFT, y << PROJECTILE_SHIFT)) return PROJECTILE_NONE;
+
+    p = Pool_Take(&projectile_pool);
+    if(p==POOL_NONE) return PROJECTILE_NONE;
+
+    projectile->sprite[p] = sprite;
+    projectile->x[p] = x << PROJECTILE_SHIFT;
+    projectile->y[p] = y << PROJECTILE_SHIFT;
+    projectile->vx[p] = vx;
+    projectile->vy[p] = vy;
+    projectile->life[p] = life;
+    projectile->owner[p] = owner;
+    return p;
+}
+
+// Removes projectile p
+void Projectile_Kill(uint8_t p){
+    Pool_Give(&projectile_pool, p);
+}
+
+// Projectiles flying, oldest first: Projectile_First then Projectile_Next
+// until PROJECTILE_NONE. p may be killed once its next one was read.
+uint8_t Projectile_First(void){
+    if(!projectile) return PROJECTILE_NONE;
+    return projectile_pool.first;
+}
+
+uint8_t Projectile_Next(uint8_t p){
+    return projectile->next[p];
+}
+
+// Position of projectile p, its bottom left corner
+void Projectile_Position(uint8_t p, uint8_t *x, uint8_t *y){
+    *x = projectile->x[p] >> PROJECTILE_SHIFT;
+    *y = projectile->y[p] >> PROJECTILE_SHIFT;
+}
+
+// Sprite and owner of projectile p
+const unsigned char *Projectile_Sprite(uint8_t p){
+    return projectile->sprite[p];
+}
+
+uint8_t Projectile_Owner(uint8_t p){
+    return projectile->owner[p];
+}
+
+// Projectiles of owner flying
+uint8_t Projectile_Count(uint8_t owner){
+    uint8_t p;
+    uint8_t n = 0;
+
+    for(p=Projectile_First();p!=PROJECTILE_NONE;p=projectile->next[p]){
+        if(projectile->owner[p]==owner) n++;
+    }
+    return n;
+}
+
+// Most projectiles flying at once since the game started
+uint8_t Projectile_High(void){
+    return projectile_pool.high;
+}
+
+// =====================================================
+// ### FLIGHT ###
+
+// Moves every projectile a tick, removing the ones that leave the screen
+// or run out of life
+RAMFUNC void Projectile_Update(void){
+    uint8_t p, next;
+    PROFILE_BEGIN();
+
+    for(p=Projectile_First();p!=PROJECTILE_NONE;p=next){
+        next = projectile->next[p];
+
+        projectile->x[p] += projectile->vx[p];
+        projectile->y[p] += projectile->vy[p];
+        if(!--projectile->life[p] ||
+           !Projectile_Inside(projectile->sprite[p], projectile->x[p], projectile->y[p])){
+            Pool_Give(&projectile_pool, p);
+        }
+    }
+
+    PROFILE_END(PROFILE_PROJECTILE);
+}
@@ -0,0 +1,64 @@
+#ifndef PROJECTILE_H
+#define PROJECTILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =====================================================
+// Projectiles
+// Sword beams and feather shots fly in a straight line for a number of
+// ticks. Their fields are arrays taken from the level arena, with a pool
+// handing out the slots, and Projectile_Update moves all of them in one
+// pass. A projectile that leaves the screen or runs out of life is gone.
+// Positions and speeds are in 1/16 pixels, the same as the swarm.
+// The level draws them and tests them against the collision boxes.
+#define PROJECTILES         32
+#define PROJECTILE_NONE     0xFF    // no projectile, end of the list
+#define PROJECTILE_SHIFT    4       // pixels to 1/16 pixels
+
+// Who fired it, and so what it can hit
+#define PROJECTILE_LINK     0       // hits the enemies
+#define PROJECTILE_ENEMY    1       // hits Link
+
+// =====================================================
+// ### PROJECTILES ###
+
+// Takes the projectiles of a new level from the level arena, with none flying
+// Call it after Arena_Reset
+void Projectile_Reset(void);
+
+// Fires sprite from (x, y), its bottom left corner, at (vx, vy) 1/16 pixels
+// a tick for life ticks
+// Returns the projectile, PROJECTILE_NONE if there is no room or it starts
+// out of the screen
+uint8_t Projectile_Fire(uint8_t owner, const unsigned char *sprite, uint8_t x, uint8_t y, int8_t vx, int8_t vy, uint8_t life);
+
+// Removes projectile p
+void Projectile_Kill(uint8_t p);
+
+// Projectiles flying, oldest first: Projectile_First then Projectile_Next
+// until PROJECTILE_NONE. p may be killed once its next one was read.
+uint8_t Projectile_First(void);
+uint8_t Projectile_Next(uint8_t p);
+
+// Position of projectile p, its bottom left corner
+void Projectile_Position(uint8_t p, uint8_t *x, uint8_t *y);
+
+// Sprite and owner of projectile p
+const unsigned char *Projectile_Sprite(uint8_t p);
+uint8_t Projectile_Owner(uint8_t p);
+
+// Projectiles of owner flying
+uint8_t Projectile_Count(uint8_t owner);
+
+// Most projectiles flying at once since the game started
+uint8_t Projectile_High(void);
+
+// =====================================================
+// ### FLIGHT ###
+
+// Moves every projectile a tick, removing the ones that leave the screen
+// or run out of life
+void Projectile_Update(void);
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef RAMFUNC_H
+#define RAMFUNC_H
+
+// =====================================================
+// Hot functions are linked into the .TI.ramfunc section.
+// It is loaded in flash and copied to SRAM by the boot routine
+// (see tm4c123gh6pm.cmd), so they run without flash wait states.
+// Build with NO_RAMFUNC defined to keep them in flash.
+
+#if defined(NO_RAMFUNC)
+#define RAMFUNC
+#elif defined(__TI_COMPILER_VERSION__)
+#define RAMFUNC __attribute__((ramfunc))
+#elif defined(__GNUC__)
+#define RAMFUNC __attribute__((section(".TI.ramfunc"), noinline))
+#else
+#define RAMFUNC
+#endif
+
+#endif
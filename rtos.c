@@ -0,0 +1,226 @@
+#include "rtos.h"
+
+#ifdef RTOS
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+#include "actions.h"
+#include "buttons.h"
+#include "game.h"
+#include "profile.h"
+#include "Nokia5110.h"
+
+// =====================================================
+// Tasks
+// The input preempts the logic and the logic preempts the render, so the
+// logic only waits for the keypad scan and the render only runs while the
+// logic sleeps until its next update
+#define RTOS_PRIORITY_RENDER    (tskIDLE_PRIORITY + 1)
+#define RTOS_PRIORITY_LOGIC     (tskIDLE_PRIORITY + 2)
+#define RTOS_PRIORITY_INPUT     (tskIDLE_PRIORITY + 3)
+
+// Stack sizes in words, on top of the port minimum
+#define RTOS_STACK_RENDER       (configMINIMAL_STACK_SIZE + 32)
+#define RTOS_STACK_LOGIC        (configMINIMAL_STACK_SIZE + 416)
+#define RTOS_STACK_INPUT        (configMINIMAL_STACK_SIZE + 32)
+
+#define RTOS_FRAME              (SCREENW * SCREENH / 8)
+
+static QueueHandle_t rtos_keys;             // last key scanned, one slot
+static SemaphoreHandle_t rtos_frame_ready;  // rtos_frame has a frame not sent yet
+static SemaphoreHandle_t rtos_lcd;          // owner of the display link
+static uint8_t rtos_frame[RTOS_FRAME];      // frame from the logic to the render
+static uint8_t rtos_first;                  // state the game starts from
+
+// =====================================================
+// ### TASKS ###
+
+// Scans the keypad at a fixed rate and keeps the last key in rtos_keys
+static void Rtos_InputTask(void *arg){
+    TickType_t wake = xTaskGetTickCount();
+    uint8_t key;
+
+    while(1){
+        key = ScanButtons();
+        xQueueOverwrite(rtos_keys, &key);
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(BUTTON_SCAN_MS));
+    }
+}
+
+// Sends every frame posted by the logic to the display
+static void Rtos_RenderTask(void *arg){
+    static uint8_t frame[RTOS_FRAME];       // frame being sent
+
+    while(1){
+        xSemaphoreTake(rtos_frame_ready, portMAX_DELAY);
+
+        // the logic may post the next frame while this one is sent
+        taskENTER_CRITICAL();
+        memcpy(frame, rtos_frame, RTOS_FRAME);
+        taskEXIT_CRITICAL();
+
+        Rtos_LcdTake();
+        Nokia5110_DrawFullImage(frame);
+        Rtos_LcdGive();
+    }
+}
+
+// Sets the hardware up, starts the other tasks and runs the game
+static void Rtos_LogicTask(void *arg){
+    Setup();
+
+    xTaskCreate(Rtos_InputTask, "INPUT", RTOS_STACK_INPUT, 0, RTOS_PRIORITY_INPUT, 0);
+    xTaskCreate(Rtos_RenderTask, "RENDER", RTOS_STACK_RENDER, 0, RTOS_PRIORITY_RENDER, 0);
+
+    Game_Run(rtos_first);
+}
+
+// Creates the tasks and starts the scheduler from the given state. Never returns
+void Rtos_Run(uint8_t first){
+    rtos_first = first;
+
+    rtos_keys = xQueueCreate(1, sizeof(uint8_t));
+    rtos_frame_ready = xSemaphoreCreateBinary();
+    rtos_lcd = xSemaphoreCreateRecursiveMutex();
+
+    xTaskCreate(Rtos_LogicTask, "LOGIC", RTOS_STACK_LOGIC, 0, RTOS_PRIORITY_LOGIC, 0);
+    vTaskStartScheduler();
+
+    // only reached if there was no memory for the idle task
+    while(1){}
+}
+
+// =====================================================
+// ### INTERFACES ###
+
+// Hands a frame to the render task. A NULL frame blanks the display
+// Frames that were not sent yet are replaced by the newest one
+void Rtos_PostFrame(const uint8_t *frame){
+    taskENTER_CRITICAL();
+    if(frame) memcpy(rtos_frame, frame, RTOS_FRAME);
+    else memset(rtos_frame, 0, RTOS_FRAME);
+    taskEXIT_CRITICAL();
+
+    xSemaphoreGive(rtos_frame_ready);
+}
+
+// Last key scanned by the input task
+uint8_t Rtos_GetButton(void){
+    uint8_t key;
+    if(xQueuePeek(rtos_keys, &key, 0) != pdPASS) return BUTTON_NOT_PRESSED;
+    return key;
+}
+
+// Takes and gives back the display link for direct writes (text screens)
+// Nested calls are allowed
+void Rtos_LcdTake(void){
+    xSemaphoreTakeRecursive(rtos_lcd, portMAX_DELAY);
+}
+
+void Rtos_LcdGive(void){
+    xSemaphoreGiveRecursive(rtos_lcd);
+}
+
+// Returns 1 if the calling task holds the display link
+bool Rtos_LcdHeld(void){
+    return xSemaphoreGetMutexHolder(rtos_lcd) == xTaskGetCurrentTaskHandle();
+}
+
+// =====================================================
+// ### STATISTICS ###
+
+// Fills usage with the CPU usage of each task since the start
+// Returns how many tasks were filled, in creation order
+uint8_t Rtos_Usage(Rtos_Usage_t *usage, uint8_t max){
+    TaskStatus_t status[RTOS_TASKS], swap;
+    configRUN_TIME_COUNTER_TYPE total;
+    UBaseType_t n, i, j;
+
+    n = uxTaskGetSystemState(status, RTOS_TASKS, &total);
+    if(!total) total = 1;
+
+    // creation order, so the lines don't move around
+    for(i=1;i<n;i++){
+        for(j=i;j>0 && status[j].xTaskNumber < status[j-1].xTaskNumber;j--){
+            swap = status[j]; status[j] = status[j-1]; status[j-1] = swap;
+        }
+    }
+
+    for(i=0;i<n && i<max;i++){
+        usage[i].name = status[i].pcTaskName;
+        usage[i].permille = (uint16_t)(status[i].ulRunTimeCounter * 1000 / total);
+    }
+    return i;
+}
+
+// Shows the CPU usage of each task straight on the display
+//  CPU %
+//  LOGIC     nn
+void Rtos_Show(void){
+    Rtos_Usage_t usage[RTOS_TASKS];
+    uint8_t n, i;
+
+    n = Rtos_Usage(usage, RTOS_TASKS);
+
+    Rtos_LcdTake();
+    Nokia5110_Clear();
+    Nokia5110_OutString("CPU %");
+
+    for(i=0;i<n && i<5;i++){
+        Nokia5110_SetCursor(0, i+1);
+        Nokia5110_OutString((char *)usage[i].name);
+        Nokia5110_SetCursor(7, i+1);
+        Nokia5110_OutUDec(usage[i].permille / 10);
+    }
+    Rtos_LcdGive();
+}
+
+// Run time counter used by FreeRTOS for the task statistics
+// The 32 bit cycle counter wraps in less than a minute at 80 MHz,
+// so it's extended to 64 bits here and on every tick
+void Rtos_RunTimeInit(void){
+    CORE_DEMCR_R |= CORE_DEMCR_TRCENA;
+    DWT_CTRL_R |= DWT_CTRL_CYCCNTENA;
+}
+
+uint64_t Rtos_RunTime(void){
+    static uint32_t last = 0;
+    static uint64_t cycles = 0;
+    UBaseType_t mask;
+    uint32_t now;
+    uint64_t result;
+
+    mask = taskENTER_CRITICAL_FROM_ISR();
+    now = DWT_CYCCNT_R;
+    cycles += now - last;
+    last = now;
+    result = cycles;
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+
+    return result;
+}
+
+// =====================================================
+// ### HOOKS ###
+
+void vApplicationTickHook(void){
+    Rtos_RunTime();
+}
+
+// Stops everything where the debugger can see it
+void vApplicationStackOverflowHook(TaskHandle_t task, char *name){
+    taskDISABLE_INTERRUPTS();
+    while(1){}
+}
+
+void vApplicationMallocFailedHook(void){
+    taskDISABLE_INTERRUPTS();
+    while(1){}
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef RTOS_H
+#define RTOS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =====================================================
+// Build with RTOS defined to run the game on FreeRTOS, split in three tasks:
+//  input   scans the keypad every BUTTON_SCAN_MS and posts the key to a queue
+//  logic   runs Setup and the game states (Game_Run)
+//  render  sends the finished frames to the display
+// Nokia5110_DisplayBuffer only copies the frame and signals the render task,
+// and GetButton only reads the last key from the queue, so neither the SSI
+// transfer nor the keypad scan stalls the game logic.
+// posix/ has the port that runs the same build on Linux.
+
+// Tasks shown by Rtos_Show and Rtos_Usage
+#define RTOS_TASKS      5
+
+// CPU usage of a task, in tenths of percent
+typedef struct{
+    const char *name;
+    uint16_t permille;
+} Rtos_Usage_t;
+
+#ifdef RTOS
+
+// Creates the tasks and starts the scheduler from the given state. Never returns
+void Rtos_Run(uint8_t first);
+
+// Hands a frame to the render task. A NULL frame blanks the display
+// Frames that were not sent yet are replaced by the newest one
+void Rtos_PostFrame(const uint8_t *frame);
+
+// Last key scanned by the input task
+uint8_t Rtos_GetButton(void);
+
+// Takes and gives back the display link for direct writes (text screens)
+// Nested calls are allowed
+void Rtos_LcdTake(void);
+void Rtos_LcdGive(void);
+
+// Returns 1 if the calling task holds the display link
+bool Rtos_LcdHeld(void);
+
+// Fills usage with the CPU usage of each task since the start
+// Returns how many tasks were filled
+uint8_t Rtos_Usage(Rtos_Usage_t *usage, uint8_t max);
+
+// Shows the CPU usage of each task straight on the display
+void Rtos_Show(void);
+
+// Run time counter used by FreeRTOS for the task statistics (DWT cycles)
+void Rtos_RunTimeInit(void);
+uint64_t Rtos_RunTime(void);
+
+#else
+
+#define Rtos_LcdTake()
+#define Rtos_LcdGive()
+#define Rtos_Show()
+
+#endif
+
+#endif
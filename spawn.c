@@ -0,0 +1,86 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "spawn.h"
+
+// Cells taken, bit c of row r is the cell of column c
+static uint16_t spawn_row[SPAWN_ROWS];
+
+// Takes the cells from column left to right and from row top to bottom
+static void Spawn_Take(int16_t left, int16_t top, int16_t right, int16_t bottom){
+    uint16_t mask;
+    int16_t r;
+
+    if(left < 0) left = 0;
+    if(top < 0) top = 0;
+    if(right >= SPAWN_COLUMNS) right = SPAWN_COLUMNS - 1;
+    if(bottom >= SPAWN_ROWS) bottom = SPAWN_ROWS - 1;
+    if(left > right || top > bottom) return;
+
+    mask = ((1U << (right - left + 1)) - 1) << left;
+    for(r=top;r<=bottom;r++) spawn_row[r] |= mask;
+}
+
+// =====================================================
+// ### GRID ###
+
+// Frees every cell
+void Spawn_Clear(void){
+    uint8_t r;
+    for(r=0;r<SPAWN_ROWS;r++) spawn_row[r] = 0;
+}
+
+// Takes the cells under a box, (x, y) being the bottom left corner
+void Spawn_Block(uint8_t x, uint8_t y, uint8_t w, uint8_t h){
+    if(!w || !h) return;
+    Spawn_Take(x / SPAWN_CELL, (y - h + 1) / SPAWN_CELL,
+               (x + w - 1) / SPAWN_CELL, y / SPAWN_CELL);
+}
+
+// Takes the cells under Link's box and SPAWN_GUARD pixels around it
+void Spawn_Guard(uint8_t x, uint8_t y, uint8_t w, uint8_t h){
+    int16_t left = x - SPAWN_GUARD;
+    int16_t top = y - h + 1 - SPAWN_GUARD;
+    int16_t right = x + w - 1 + SPAWN_GUARD;
+    int16_t bottom = y + SPAWN_GUARD;
+
+    // cells left or above the screen start below 0
+    Spawn_Take(left < 0 ? -1 : left / SPAWN_CELL, top < 0 ? -1 : top / SPAWN_CELL,
+               right / SPAWN_CELL, bottom / SPAWN_CELL);
+}
+
+// =====================================================
+// ### PLACES ###
+
+// Picks a random place for a w x h box on free cells, inside the screen
+// Every column and row where the box fits is a place; the free ones are
+// listed and one of them is drawn
+// Returns 0 if there is none, else its bottom left corner in x, y
+bool Spawn_Pick(uint8_t w, uint8_t h, uint8_t *x, uint8_t *y){
+    uint8_t place[SPAWN_CELLS];     // free places, column + SPAWN_COLUMNS * row
+    uint8_t places = 0;
+    uint8_t columns = (w + SPAWN_CELL - 1) / SPAWN_CELL;    // cells the box covers
+    uint8_t rows = (h + SPAWN_CELL - 1) / SPAWN_CELL;
+    uint16_t mask, taken;
+    uint8_t c, r, k, p;
+
+    if(!w || !h || w > 84 || h > 48) return 0;
+    mask = (1U << columns) - 1;
+
+    for(r=0;r*SPAWN_CELL+h<=48;r++){
+        // cells taken in any row of the box
+        taken = 0;
+        for(k=0;k<rows;k++) taken |= spawn_row[r + k];
+
+        for(c=0;c*SPAWN_CELL+w<=84;c++){
+            if(!(taken & (mask << c))) place[places++] = c + SPAWN_COLUMNS * r;
+        }
+    }
+    if(!places) return 0;
+
+    p = place[rand() % places];
+    *x = (p % SPAWN_COLUMNS) * SPAWN_CELL;
+    *y = (p / SPAWN_COLUMNS) * SPAWN_CELL + h - 1;
+    return 1;
+}
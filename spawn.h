@@ -0,0 +1,43 @@
+#ifndef SPAWN_H
+#define SPAWN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =====================================================
+// Spawn planner
+// The screen is split in cells of SPAWN_CELL pixels, a cell is taken once
+// something is on it or it is within SPAWN_GUARD pixels of Link. A monster
+// coming anywhere is put at random on one of the places whose cells are all
+// free: they are listed in one pass over the grid, with a row of cells in a
+// word, so placing one costs the same however crowded the level is and
+// nothing is tried twice.
+#define SPAWN_CELL          8
+#define SPAWN_COLUMNS       ((84 + SPAWN_CELL - 1) / SPAWN_CELL)
+#define SPAWN_ROWS          ((48 + SPAWN_CELL - 1) / SPAWN_CELL)
+#define SPAWN_CELLS         (SPAWN_COLUMNS * SPAWN_ROWS)
+#define SPAWN_GUARD         8       // pixels around Link nothing comes in
+
+// Position of a monster that may come anywhere (Level_Spawn_t)
+#define SPAWN_ANYWHERE      0xFF
+
+// =====================================================
+// ### GRID ###
+
+// Frees every cell
+void Spawn_Clear(void);
+
+// Takes the cells under a box, (x, y) being the bottom left corner
+void Spawn_Block(uint8_t x, uint8_t y, uint8_t w, uint8_t h);
+
+// Takes the cells under Link's box and SPAWN_GUARD pixels around it
+void Spawn_Guard(uint8_t x, uint8_t y, uint8_t w, uint8_t h);
+
+// =====================================================
+// ### PLACES ###
+
+// Picks a random place for a w x h box on free cells, inside the screen
+// Returns 0 if there is none, else its bottom left corner in x, y
+bool Spawn_Pick(uint8_t w, uint8_t h, uint8_t *x, uint8_t *y);
+
+#endif
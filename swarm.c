@@ -0,0 +1,190 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "swarm.h"
+#include "ramfunc.h"
+#include "profile.h"
+
+// =====================================================
+// Positions and speeds in 1/16 pixels
+#define SWARM_SHIFT         4
+#define SWARM_ONE           (1 << SWARM_SHIFT)
+
+// Neighbours closer than this are flocked with, and closer than the
+// personal space they are pushed away. Both fit in a cell
+#define SWARM_RADIUS        (10 * SWARM_ONE)
+#define SWARM_PERSONAL      (5 * SWARM_ONE)
+
+// Weight of each rule, as a right shift of its steer
+#define SWARM_SEPARATION    2
+#define SWARM_ALIGNMENT     3
+#define SWARM_COHESION      5
+#define SWARM_SEEK          6
+
+// Top speed on each axis, a bit slower than Link
+#define SWARM_SPEED         (3 * SWARM_ONE / 2)
+
+#define SWARM_MAX_X         ((84 - SWARM_WIDTH) * SWARM_ONE)
+#define SWARM_MIN_Y         ((SWARM_HEIGHT - 1) * SWARM_ONE)
+#define SWARM_MAX_Y         (47 * SWARM_ONE)
+
+#define SWARM_NONE          0xFF    // end of a cell list
+
+static int16_t swarm_x[SWARM_AGENTS], swarm_y[SWARM_AGENTS];
+static int16_t swarm_vx[SWARM_AGENTS], swarm_vy[SWARM_AGENTS];
+static uint8_t swarm_count;
+
+// Grid of the tick, a list of cuccos for each cell
+static uint8_t swarm_head[SWARM_CELLS];
+static uint8_t swarm_next[SWARM_AGENTS];
+
+// =====================================================
+// ### AGENTS ###
+
+// Removes every cucco
+void Swarm_Reset(void){
+    swarm_count = 0;
+}
+
+// Adds a cucco at (x, y), its bottom left corner
+// Returns 0 if the swarm is full
+bool Swarm_Add(uint8_t x, uint8_t y){
+    if(swarm_count==SWARM_AGENTS) return 0;
+
+    swarm_x[swarm_count] = x << SWARM_SHIFT;
+    swarm_y[swarm_count] = y << SWARM_SHIFT;
+    swarm_vx[swarm_count] = 0;
+    swarm_vy[swarm_count] = 0;
+    swarm_count++;
+    return 1;
+}
+
+// Number of cuccos in the swarm
+uint8_t Swarm_Count(void){
+    return swarm_count;
+}
+
+// Position of cucco i, its bottom left corner
+void Swarm_Position(uint8_t i, uint8_t *x, uint8_t *y){
+    *x = swarm_x[i] >> SWARM_SHIFT;
+    *y = swarm_y[i] >> SWARM_SHIFT;
+}
+
+// Sends cucco i away from (x, y), at full speed
+void Swarm_Repel(uint8_t i, uint8_t x, uint8_t y){
+    swarm_vx[i] = (swarm_x[i] >> SWARM_SHIFT) < x ? -SWARM_SPEED : SWARM_SPEED;
+    swarm_vy[i] = (swarm_y[i] >> SWARM_SHIFT) < y ? -SWARM_SPEED : SWARM_SPEED;
+}
+
+// =====================================================
+// ### FLOCKING ###
+
+static uint8_t Swarm_Cell(uint8_t i){
+    uint8_t column = (swarm_x[i] >> SWARM_SHIFT) / SWARM_CELL;
+    uint8_t row = (swarm_y[i] >> SWARM_SHIFT) / SWARM_CELL;
+    return row * SWARM_COLUMNS + column;
+}
+
+static int16_t Swarm_Limit(int32_t v){
+    if(v > SWARM_SPEED) return SWARM_SPEED;
+    if(v < -SWARM_SPEED) return -SWARM_SPEED;
+    return v;
+}
+
+// Moves the swarm a tick, towards (x, y)
+RAMFUNC void Swarm_Update(uint8_t x, uint8_t y){
+    static int16_t vx[SWARM_AGENTS], vy[SWARM_AGENTS]; // speeds of the next tick
+    int32_t dx, dy;                 // from the cucco to a neighbour
+    int32_t sx, sy;                 // separation
+    int32_t px, py, ax, ay;         // sum of the neighbours positions and speeds
+    int32_t tx, ty;                 // target
+    uint8_t i, k, cell;
+    uint8_t seen, n;                // cuccos looked at, and flocked with
+    int8_t column, row, c, r;
+    PROFILE_BEGIN();
+
+    // the grid of this tick
+    for(cell=0;cell<SWARM_CELLS;cell++) swarm_head[cell] = SWARM_NONE;
+    for(i=0;i<swarm_count;i++){
+        cell = Swarm_Cell(i);
+        swarm_next[i] = swarm_head[cell];
+        swarm_head[cell] = i;
+    }
+
+    tx = x << SWARM_SHIFT;
+    ty = y << SWARM_SHIFT;
+
+    for(i=0;i<swarm_count;i++){
+        sx = sy = px = py = ax = ay = 0;
+        seen = n = 0;
+
+        column = (swarm_x[i] >> SWARM_SHIFT) / SWARM_CELL;
+        row = (swarm_y[i] >> SWARM_SHIFT) / SWARM_CELL;
+
+        // the 3x3 cells around, SWARM_NEIGHBOURS at most
+        for(r=row-1;r<=row+1 && seen<SWARM_NEIGHBOURS;r++){
+            if(r < 0 || r >= SWARM_ROWS) continue;
+            for(c=column-1;c<=column+1 && seen<SWARM_NEIGHBOURS;c++){
+                if(c < 0 || c >= SWARM_COLUMNS) continue;
+
+                for(k=swarm_head[r*SWARM_COLUMNS+c];k!=SWARM_NONE && seen<SWARM_NEIGHBOURS;k=swarm_next[k]){
+                    if(k==i) continue;
+                    seen++;
+
+                    dx = swarm_x[k] - swarm_x[i];
+                    dy = swarm_y[k] - swarm_y[i];
+                    if(dx*dx + dy*dy > SWARM_RADIUS*SWARM_RADIUS) continue;
+
+                    if(dx*dx + dy*dy < SWARM_PERSONAL*SWARM_PERSONAL){
+                        sx -= dx;
+                        sy -= dy;
+                    }
+                    px += dx;
+                    py += dy;
+                    ax += swarm_vx[k];
+                    ay += swarm_vy[k];
+                    n++;
+                }
+            }
+        }
+
+        dx = (sx >> SWARM_SEPARATION) + ((tx - swarm_x[i]) >> SWARM_SEEK);
+        dy = (sy >> SWARM_SEPARATION) + ((ty - swarm_y[i]) >> SWARM_SEEK);
+        if(n){
+            dx += (px / n) >> SWARM_COHESION;
+            dy += (py / n) >> SWARM_COHESION;
+            dx += (ax / n - swarm_vx[i]) >> SWARM_ALIGNMENT;
+            dy += (ay / n - swarm_vy[i]) >> SWARM_ALIGNMENT;
+        }
+
+        vx[i] = Swarm_Limit(swarm_vx[i] + dx);
+        vy[i] = Swarm_Limit(swarm_vy[i] + dy);
+    }
+
+    // every cucco moves with the speeds of the same tick, bouncing on the borders
+    for(i=0;i<swarm_count;i++){
+        swarm_vx[i] = vx[i];
+        swarm_vy[i] = vy[i];
+        swarm_x[i] += vx[i];
+        swarm_y[i] += vy[i];
+
+        if(swarm_x[i] < 0){
+            swarm_x[i] = 0;
+            swarm_vx[i] = -swarm_vx[i];
+        }
+        if(swarm_x[i] > SWARM_MAX_X){
+            swarm_x[i] = SWARM_MAX_X;
+            swarm_vx[i] = -swarm_vx[i];
+        }
+        if(swarm_y[i] < SWARM_MIN_Y){
+            swarm_y[i] = SWARM_MIN_Y;
+            swarm_vy[i] = -swarm_vy[i];
+        }
+        if(swarm_y[i] > SWARM_MAX_Y){
+            swarm_y[i] = SWARM_MAX_Y;
+            swarm_vy[i] = -swarm_vy[i];
+        }
+    }
+
+    PROFILE_END(PROFILE_SWARM);
+}
@@ -0,0 +1,50 @@
+#ifndef SWARM_H
+#define SWARM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =====================================================
+// Cucco swarm
+// Boids in fixed point: each cucco steers away from the ones too close,
+// matches the speed of its neighbours, closes in on them and seeks Link.
+// The neighbours come from a grid of SWARM_CELL pixels rebuilt every tick,
+// and no more than SWARM_NEIGHBOURS of them are looked at, so a cucco costs
+// the same whatever the size of the swarm.
+#define SWARM_AGENTS        24
+#define SWARM_CELL          16
+#define SWARM_COLUMNS       ((84 + SWARM_CELL - 1) / SWARM_CELL)
+#define SWARM_ROWS          ((48 + SWARM_CELL - 1) / SWARM_CELL)
+#define SWARM_CELLS         (SWARM_COLUMNS * SWARM_ROWS)
+#define SWARM_NEIGHBOURS    8
+
+// Size of a cucco of the swarm (swarm_sprite in bitmaps.h)
+#define SWARM_WIDTH         6
+#define SWARM_HEIGHT        5
+
+// =====================================================
+// ### AGENTS ###
+
+// Removes every cucco
+void Swarm_Reset(void);
+
+// Adds a cucco at (x, y), its bottom left corner
+// Returns 0 if the swarm is full
+bool Swarm_Add(uint8_t x, uint8_t y);
+
+// Number of cuccos in the swarm
+uint8_t Swarm_Count(void);
+
+// Position of cucco i, its bottom left corner
+void Swarm_Position(uint8_t i, uint8_t *x, uint8_t *y);
+
+// Sends cucco i away from (x, y), at full speed
+void Swarm_Repel(uint8_t i, uint8_t x, uint8_t y);
+
+// =====================================================
+// ### FLOCKING ###
+
+// Moves the swarm a tick, towards (x, y)
+void Swarm_Update(uint8_t x, uint8_t y);
+
+#endif
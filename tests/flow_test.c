@@ -0,0 +1,90 @@
+// Host test of the flow field (flow.c), a level tick at a time the way
+// Enemy_Move drives it: Flow_Target then Flow_Step(FLOW_BUDGET)
+// gcc -std=gnu99 -DNO_RAMFUNC -I. tests/flow_test.c flow.c -o flow_test && ./flow_test
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "flow.h"
+
+// Ticks a full search takes, and a search left running plus a new one
+#define SEARCH_TICKS    ((FLOW_CELLS + FLOW_BUDGET - 1) / FLOW_BUDGET)
+#define CATCH_UP        (2 * SEARCH_TICKS + 1)
+
+static int failures = 0;
+
+static void Check(bool ok, const char *what){
+    if(!ok){
+        printf("FAIL %s\n", what);
+        failures++;
+    }
+}
+
+static void Tick(uint8_t x, uint8_t y){
+    Flow_Target(x, y);
+    Flow_Step(FLOW_BUDGET);
+}
+
+// A target that stays leads a point to it around a wall
+static void Test_Still(void){
+    int8_t dx = 0, dy = 0;
+    uint8_t t;
+
+    Flow_Reset();
+    Flow_Block(40, 47, 4, 40);          // a wall from row 8 to the bottom
+    for(t=0;t<SEARCH_TICKS;t++) Tick(70, 40);
+
+    Check(Flow_Direction(20, 40, &dx, &dy), "still: field ready");
+    Check(dy < 0, "still: goes up around the wall");
+    Check(Flow_Direction(70, 40, &dx, &dy)==0, "still: nothing to do on the target");
+}
+
+// A target walking 2 pixels a tick, a new cell every other tick, keeps the
+// field up to date: once it is past a point, the point is led the other way
+static void Test_Moving(void){
+    int8_t dx = 0, dy = 0;
+    uint8_t x, t;
+    bool left, right = false;
+
+    Flow_Reset();
+    for(x=0;x<=40;x+=2) Tick(x, 24);
+    left = Flow_Direction(60, 24, &dx, &dy) && dx < 0;
+    Check(left, "moving: a point ahead is led back to the target");
+
+    // still walking, from the cell after the point's
+    for(x=44,t=0;x<84 && t<CATCH_UP && !right;x+=2,t++){
+        Tick(x, 24);
+        right = Flow_Direction(40, 24, &dx, &dy) && dx > 0;
+    }
+    Check(right, "moving: a point passed is led after the target");
+
+    // walking back and forth all the time
+    for(t=0;t<100;t++) Tick(t & 1 ? 80 : 76, 24);
+    Check(Flow_Direction(10, 24, &dx, &dy) && dx > 0, "moving: field kept while the target jitters");
+}
+
+// Obstacles that change start the search again at once
+static void Test_Obstacles(void){
+    int8_t dx = 0, dy = 0;
+    uint8_t t;
+
+    Flow_Reset();
+    for(t=0;t<SEARCH_TICKS;t++) Tick(70, 24);
+    Check(Flow_Direction(20, 24, &dx, &dy) && dx > 0, "obstacles: towards the target before the wall");
+
+    Flow_Clear();
+    Flow_Block(40, 47, 4, 40);
+    for(t=0;t<SEARCH_TICKS+1;t++) Tick(70, 24);
+    Check(Flow_Direction(20, 40, &dx, &dy) && dy < 0, "obstacles: around the new wall");
+}
+
+int main(void){
+    Test_Still();
+    Test_Moving();
+    Test_Obstacles();
+
+    if(failures) return 1;
+    printf("flow: all passed\n");
+    return 0;
+}
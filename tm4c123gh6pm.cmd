@@ -34,6 +34,14 @@ SECTIONS
     .cinit  :   > FLASH
     .pinit  :   > FLASH
     .init_array : > FLASH
+    .binit  :   > FLASH
+
+    /* Hot functions marked RAMFUNC (see ramfunc.h) are stored in flash and */
+    /* copied to SRAM by the boot routine through the BINIT copy table,     */
+    /* so they run without flash wait states at 80 MHz.                     */
+    /* __ramfunc_size is the SRAM they take, reported by Profile_Show.      */
+    .TI.ramfunc : {} load = FLASH, run = SRAM, table(BINIT),
+                  RUN_START(__ramfunc_start), SIZE(__ramfunc_size)
 
     .vtable :   > 0x20000000
     .data   :   > SRAM
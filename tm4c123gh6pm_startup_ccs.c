@@ -56,6 +56,21 @@ extern uint32_t __STACK_TOP;
 //*****************************************************************************
 // To be added by user
 // void PortFIntHandler();
+extern void Clock_SysTickHandler(void);
+
+// FreeRTOS port handlers for the RTOS build
+#ifdef RTOS
+extern void vPortSVCHandler(void);
+extern void xPortPendSVHandler(void);
+extern void xPortSysTickHandler(void);
+#define SVCALL_HANDLER  vPortSVCHandler
+#define PENDSV_HANDLER  xPortPendSVHandler
+#define SYSTICK_HANDLER xPortSysTickHandler
+#else
+#define SVCALL_HANDLER  IntDefaultHandler
+#define PENDSV_HANDLER  IntDefaultHandler
+#define SYSTICK_HANDLER Clock_SysTickHandler
+#endif
 
 //*****************************************************************************
 //
@@ -79,11 +94,11 @@ void (* const g_pfnVectors[])(void) =
     0,                                      // Reserved
     0,                                      // Reserved
     0,                                      // Reserved
-    IntDefaultHandler,                      // SVCall handler
+    SVCALL_HANDLER,                         // SVCall handler
     IntDefaultHandler,                      // Debug monitor handler
     0,                                      // Reserved
-    IntDefaultHandler,                      // The PendSV handler
-    IntDefaultHandler,                      // The SysTick handler
+    PENDSV_HANDLER,                         // The PendSV handler
+    SYSTICK_HANDLER,                        // The SysTick handler
     IntDefaultHandler,                      // GPIO Port A
     IntDefaultHandler,                      // GPIO Port B
     IntDefaultHandler,                      // GPIO Port C
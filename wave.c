@@ -0,0 +1,98 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "wave.h"
+#include "spawn.h"
+
+// =====================================================
+// A kind of monster the waves are made of
+typedef struct{
+    uint8_t type;                       // monster code
+    uint8_t threat;                     // what it takes of the threat budget
+    uint8_t wave;                       // first wave it comes in
+} Wave_Kind_t;
+
+// Cheapest first, which is also the order they are unlocked in
+static const Wave_Kind_t wave_kind[] = {
+    {GRASS,             1,  0},
+    {CUCCO,             2,  0},
+    {ANGRY_CUCCO,       3,  1},
+    {OLDMAN,            4,  3},
+    {MADCUCCO,          5,  6},
+};
+#define WAVE_KINDS      (sizeof(wave_kind) / sizeof(wave_kind[0]))
+
+static const Wave_Kind_t wave_boss[] = {
+    {GRAND_CUCCO,       8,  0},
+    {GRAND_MADCUCCO,    12, 9},
+};
+#define WAVE_BOSSES     (sizeof(wave_boss) / sizeof(wave_boss[0]))
+
+// Two records, the wave being played and the next one
+static Level_Spawn_t wave_spawn[2][WAVE_ENEMIES];
+static Level_Def_t wave_def[2];
+static uint8_t wave_buffer;             // buffer of the wave made last
+static uint16_t wave_planned = 0xFFFF;  // number of the wave made last
+
+// =====================================================
+// ### WAVES ###
+
+// Forgets the wave made last, for a new game
+void Wave_Reset(void){
+    wave_planned = 0xFFFF;
+}
+
+// Makes wave n, the first being 0, in the buffer the last wave isn't using
+// Nothing is done if it is the wave made last
+void Wave_Plan(uint16_t n){
+    Level_Spawn_t *spawn;
+    const Wave_Kind_t *kind;
+    uint32_t threat;        // budget left
+    uint8_t gap;            // level ticks between the monsters that come late
+    uint8_t unlocked;       // kinds of monster the wave can have
+    uint8_t count = 0;      // monsters of the wave
+    uint8_t k;
+
+    if(n==wave_planned) return;
+    wave_planned = n;
+    wave_buffer ^= 1;
+    spawn = wave_spawn[wave_buffer];
+
+    // the difficulty curve
+    threat = WAVE_THREAT + (uint32_t)n * WAVE_GROWTH;
+    gap = (uint32_t)n * WAVE_HASTE < WAVE_GAP - WAVE_GAP_MIN ? WAVE_GAP - n * WAVE_HASTE : WAVE_GAP_MIN;
+    for(unlocked=0;unlocked<WAVE_KINDS && wave_kind[unlocked].wave<=n;unlocked++);
+
+    // a boss leads the wave
+    if(n % WAVE_BOSS == WAVE_BOSS - 1){
+        for(k=0;k<WAVE_BOSSES && wave_boss[k].wave<=n;k++);
+        kind = &wave_boss[rand() % k];
+        spawn[count++] = (Level_Spawn_t){kind->type, SPAWN_ANYWHERE, 0, 0};
+        threat = threat > kind->threat ? threat - kind->threat : 0;
+    }
+
+    while(count < WAVE_ENEMIES && threat){
+        // a random kind, a stronger one if the slots left can't spend the
+        // budget, and a weaker one if it doesn't fit in it
+        k = rand() % unlocked;
+        while(k + 1 < unlocked && (uint32_t)wave_kind[k].threat * (WAVE_ENEMIES - count) < threat) k++;
+        while(k && wave_kind[k].threat > threat) k--;
+        kind = &wave_kind[k];
+        threat -= kind->threat;
+
+        spawn[count] = (Level_Spawn_t){kind->type, SPAWN_ANYWHERE, 0, count < WAVE_OPENING ? 0 : gap};
+        count++;
+    }
+
+    wave_def[wave_buffer].spawn = spawn;
+    wave_def[wave_buffer].spawns = count;
+    wave_def[wave_buffer].kills = count;
+    wave_def[wave_buffer].cutscene = CUTSCENE_NONE;
+}
+
+// Record of wave n, made now if Wave_Plan wasn't called for it
+const Level_Def_t *Wave_Get(uint16_t n){
+    Wave_Plan(n);
+    return &wave_def[wave_buffer];
+}
@@ -0,0 +1,41 @@
+#ifndef WAVE_H
+#define WAVE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "definitions.h"
+
+// =====================================================
+// Survivor mode waves
+// Each wave is a level record made from its number. A wave has a threat
+// budget that grows along the difficulty curve below, spent on the kinds of
+// monster already unlocked, each with a threat of its own; every WAVE_BOSS
+// waves a boss leads it. WAVE_OPENING monsters come with the wave and the
+// others one at a time, closer together as the waves go on. They all come
+// anywhere, on a free place the spawn planner picks when they arrive.
+// The next wave is made while Link walks out of the last one, in a buffer
+// of its own, so starting it costs nothing.
+#define WAVE_ENEMIES        12      // most monsters in a wave, within ENEMIES and the screen
+#define WAVE_THREAT         3       // threat budget of the first wave
+#define WAVE_GROWTH         2       // threat budget added each wave
+#define WAVE_BOSS           5       // a boss leads every WAVE_BOSS waves
+#define WAVE_OPENING        3       // monsters that come with the wave
+#define WAVE_GAP            48      // level ticks between the others in the first wave
+#define WAVE_HASTE          4       // level ticks taken off the gap each wave
+#define WAVE_GAP_MIN        12      // shortest gap
+
+// =====================================================
+// ### WAVES ###
+
+// Forgets the wave made last, for a new game
+void Wave_Reset(void);
+
+// Makes wave n, the first being 0, in the buffer the last wave isn't using
+// Nothing is done if it is the wave made last
+void Wave_Plan(uint16_t n);
+
+// Record of wave n, made now if Wave_Plan wasn't called for it
+const Level_Def_t *Wave_Get(uint16_t n);
+
+#endif